@@ -6,12 +6,22 @@
 
 #pragma once
 
+#include <stdio.h>
 #include "private/elf_types.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/**
+ * @brief Statistics of a streamed load.
+ */
+typedef struct esp_elf_load_stats {
+    uint32_t    load_us;        /*!< Time spent reading and relocating in microseconds */
+    uint32_t    peak_bytes;     /*!< Peak memory held by the loader including the image */
+    uint32_t    cur_bytes;      /*!< Memory currently held, internal use */
+} esp_elf_load_stats_t;
+
 /**
  * @brief Map symbol's address of ELF to physic space.
  *
@@ -41,6 +51,31 @@ int esp_elf_init(esp_elf_t *elf);
  */
 int esp_elf_relocate(esp_elf_t *elf, const uint8_t *pbuf);
 
+/**
+ * @brief Decode and relocate ELF data by streaming it from a file.
+ *
+ * @param elf   - ELF object pointer
+ * @param fp    - ELF file opened for binary reading
+ * @param stats - Load time and peak memory report, may be NULL
+ *
+ * @return ESP_OK if success or other if failed.
+ */
+int esp_elf_relocate_file(esp_elf_t *elf, FILE *fp, esp_elf_load_stats_t *stats);
+
+struct esp_elfsym;
+
+/**
+ * @brief Collect the symbols an ELF exports in its dynamic symbol table.
+ *
+ * @param elf  - ELF object relocated from fp
+ * @param fp   - The same ELF file
+ * @param syms - Filled with a table sorted by name and terminated by ESP_ELFSYM_END,
+ *               release with free()
+ *
+ * @return Number of exported symbols if success or negative errno if failed.
+ */
+int esp_elf_export_symbols(esp_elf_t *elf, FILE *fp, struct esp_elfsym **syms);
+
 /**
  * @brief Request running relocated ELF function.
  *
@@ -49,6 +49,8 @@ void esp_elf_free(void *ptr);
 int esp_elf_arch_relocate(esp_elf_t *elf, const elf32_rela_t *rela,
                           const elf32_sym_t *sym, uint32_t addr);
 
+uintptr_t esp_elf_run_addr(esp_elf_t *elf, uintptr_t addr);
+
 /**
  * @brief Remap symbol from ".data" to ".text" section.
  *
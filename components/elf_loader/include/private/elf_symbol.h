@@ -0,0 +1,80 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ESP_ELFSYM_EXPORT(_sym)     { #_sym, &_sym }
+#define ESP_ELFSYM_END              { NULL,  NULL }
+
+/** @brief Function symbol description */
+
+struct esp_elfsym {
+    const char  *name;      /*!< Function name */
+    const void  *sym;       /*!< Function pointer */
+};
+
+/**
+ * @brief Register a symbol table for ELF relocation.
+ *
+ * @param symbols - Table terminated by ESP_ELFSYM_END, must stay valid while registered
+ * @param ns      - Unique name of the exporting subsystem, must stay valid while registered
+ *
+ * @return 0 if success, -EINVAL, -EEXIST if ns is taken or -ENOMEM.
+ */
+int elf_register_symbols(const struct esp_elfsym *symbols, const char *ns);
+
+/**
+ * @brief Unregister the symbol table of a namespace.
+ *
+ * @param ns - Namespace given to elf_register_symbols
+ *
+ * @return 0 if success or -ENOENT.
+ */
+int elf_unregister_symbols(const char *ns);
+
+/**
+ * @brief Replace the table of the "custom" namespace, see elf_register_symbols.
+ *
+ * @param symbols - Table terminated by ESP_ELFSYM_END, NULL removes it
+ */
+void elf_set_custom_symbols(const struct esp_elfsym* symbols);
+
+/** @brief Symbol table that is only visible to the ELF objects it is given to */
+
+struct esp_elfsym_scope {
+    const struct esp_elfsym *syms;  /*!< Table sorted by name */
+    uint32_t count;                 /*!< Number of symbols in syms */
+};
+
+/**
+ * @brief Find symbol address by name.
+ *
+ * @param sym_name - Symbol name
+ *
+ * @return Symbol address if success or 0 if failed.
+ */
+uintptr_t elf_find_sym(const char *sym_name);
+
+/**
+ * @brief Find symbol address by name, falling back to the tables of a load scope.
+ *
+ * @param sym_name - Symbol name
+ * @param scope    - Tables searched after all registered and built-in tables, may be NULL
+ * @param count    - Number of tables in scope
+ *
+ * @return Symbol address if success or 0 if failed.
+ */
+uintptr_t elf_find_sym_scope(const char *sym_name, const struct esp_elfsym_scope *scope, uint32_t count);
+
+#ifdef __cplusplus
+}
+#endif
@@ -66,6 +66,12 @@ extern "C" {
 #define SHF_EXECINSTR   4               /*!< machine code */
 #define SHF_MASKPROG    0xf0000000      /*!< reserved for processor-specific semantics */
 
+/** @brief Symbol Bindings */
+
+#define STB_LOCAL       0               /*!< symbol is not visible outside the object */
+#define STB_GLOBAL      1               /*!< symbol is visible to all objects */
+#define STB_WEAK        2               /*!< global symbol with lower precedence */
+
 /** @brief Symbol Types */
 
 #define STT_NOTYPE      0               /*!< symbol type is unspecified */
@@ -219,6 +225,31 @@ typedef struct esp_elf_sec {
     size_t          size;               /*!< section size */
 } esp_elf_sec_t;
 
+/** @brief Kinds of prelinked relocation targets */
+
+#define ELF_FIXUP_NONE          0       /*!< relocation needs no target address */
+#define ELF_FIXUP_ABS           1       /*!< absolute address of a firmware symbol */
+#define ELF_FIXUP_MAP           2       /*!< ELF virtual address, mapped at load time */
+
+/** @brief Resolved target of one relocation entry */
+
+typedef struct esp_elf_fixup {
+    uint32_t        kind;               /*!< ELF_FIXUP_* */
+    uint32_t        value;              /*!< absolute or ELF virtual address */
+} esp_elf_fixup_t;
+
+/** @brief Prelink table, one fixup per relocation entry in file order */
+
+typedef struct esp_elf_prelink {
+    esp_elf_fixup_t *fixups;            /*!< fixup array */
+    uint32_t         count;             /*!< valid entries */
+    uint32_t         capacity;          /*!< allocated entries when recording */
+    uint32_t         pos;               /*!< next entry to apply */
+    bool             record;            /*!< true: record resolved symbols, false: apply fixups */
+} esp_elf_prelink_t;
+
+struct esp_elfsym_scope;
+
 /** @brief ELF object */
 
 typedef struct esp_elf {
@@ -234,6 +265,21 @@ typedef struct esp_elf {
 
     int (*entry)(int argc, char *argv[]);               /*!< Entry pointer of ELF */
 
+    esp_elf_prelink_t *prelink;         /*!< optional prelink table, set after esp_elf_init */
+
+    uintptr_t        text_run;          /*!< if not 0, ".text" is relocated to run from this
+                                             address (execute in place) and only staged in RAM */
+
+    unsigned char   *data_buf;          /*!< optional caller-owned buffer for ".data", ".rodata",
+                                             ".data.rel.ro" and ".bss", never freed by the loader */
+
+    size_t           data_buf_size;     /*!< size of data_buf */
+
+    const struct esp_elfsym_scope *scope; /*!< optional symbol tables only this object links
+                                               against, set after esp_elf_init */
+
+    uint32_t         scope_count;       /*!< number of tables in scope */
+
 #ifdef CONFIG_ELF_LOADER_SET_MMU
     uint32_t        text_off;           /* .text symbol offset */
 
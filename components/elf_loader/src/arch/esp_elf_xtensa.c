@@ -87,7 +87,7 @@ int esp_elf_arch_relocate(esp_elf_t *elf, const elf32_rela_t *rela,
 
     switch (ELF_R_TYPE(rela->info)) {
     case R_XTENSA_RELATIVE:
-        val = esp_elf_map_sym(elf, *where);
+        val = esp_elf_run_addr(elf, esp_elf_map_sym(elf, *where));
 #ifdef CONFIG_ELF_LOADER_CACHE_OFFSET
         *where = elf_remap_text(elf, val);
 #else
@@ -98,6 +98,7 @@ int esp_elf_arch_relocate(esp_elf_t *elf, const elf32_rela_t *rela,
         break;
     case R_XTENSA_GLOB_DAT:
     case R_XTENSA_JMP_SLOT:
+        addr = esp_elf_run_addr(elf, addr);
 #ifdef CONFIG_ELF_LOADER_CACHE_OFFSET
         *where = elf_remap_text(elf, addr);
 #else
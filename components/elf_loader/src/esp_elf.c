@@ -0,0 +1,1407 @@
+/*
+ * SPDX-FileCopyrightText: 2023-2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/errno.h>
+#include <sys/param.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "soc/soc_caps.h"
+
+#if SOC_CACHE_INTERNAL_MEM_VIA_L1CACHE
+#include "hal/cache_ll.h"
+#endif
+
+#include "esp_elf.h"
+#include "private/elf_symbol.h"
+#include "private/elf_platform.h"
+
+#define stype(_s, _t)               ((_s)->type == (_t))
+#define sflags(_s, _f)              (((_s)->flags & (_f)) == (_f))
+#define ADDR_OFFSET                 (0x400)
+
+static const char *TAG = "ELF";
+
+/** @brief External symbols already resolved during the current load */
+
+typedef struct esp_elf_symcache {
+    uintptr_t   *addr;          /*!< Address per symbol table index, 0 = not resolved yet */
+    uint32_t    count;          /*!< Number of entries in addr */
+#ifndef NDEBUG
+    uint32_t    lookups;        /*!< Symbols resolved through elf_find_sym */
+    uint32_t    hits;           /*!< Symbols served from the cache */
+#endif
+} esp_elf_symcache_t;
+
+#if CONFIG_ELF_LOADER_BUS_ADDRESS_MIRROR
+
+/**
+ * @brief Find the loadable sections of ELF and record them in the ELF object.
+ *
+ * @param elf     - ELF object pointer
+ * @param shdr    - ELF section header table
+ * @param shnum   - Number of section headers
+ * @param shstrab - ELF section name string table
+ *
+ * @return ESP_OK if success or other if failed.
+ */
+
+static int esp_elf_scan_sections(esp_elf_t *elf, const elf32_shdr_t *shdr,
+                                 uint32_t shnum, const char *shstrab)
+{
+    /* Calculate ELF image size */
+
+    for (uint32_t i = 0; i < shnum; i++) {
+        const char *name = shstrab + shdr[i].name;
+
+        if (stype(&shdr[i], SHT_PROGBITS) && sflags(&shdr[i], SHF_ALLOC)) {
+            if (sflags(&shdr[i], SHF_EXECINSTR) && !strcmp(ELF_TEXT, name)) {
+                ESP_LOGD(TAG, ".text   sec addr=0x%08x size=0x%08x offset=0x%08x",
+                         shdr[i].addr, shdr[i].size, shdr[i].offset);
+
+                elf->sec[ELF_SEC_TEXT].v_addr  = shdr[i].addr;
+                elf->sec[ELF_SEC_TEXT].size    = ELF_ALIGN(shdr[i].size, 4);
+                elf->sec[ELF_SEC_TEXT].offset  = shdr[i].offset;
+
+                ESP_LOGD(TAG, ".text   offset is 0x%lx size is 0x%x",
+                         elf->sec[ELF_SEC_TEXT].offset,
+                         elf->sec[ELF_SEC_TEXT].size);
+            } else if (sflags(&shdr[i], SHF_WRITE) && !strcmp(ELF_DATA, name)) {
+                ESP_LOGD(TAG, ".data   sec addr=0x%08x size=0x%08x offset=0x%08x",
+                         shdr[i].addr, shdr[i].size, shdr[i].offset);
+
+                elf->sec[ELF_SEC_DATA].v_addr  = shdr[i].addr;
+                elf->sec[ELF_SEC_DATA].size    = shdr[i].size;
+                elf->sec[ELF_SEC_DATA].offset  = shdr[i].offset;
+
+                ESP_LOGD(TAG, ".data   offset is 0x%lx size is 0x%x",
+                         elf->sec[ELF_SEC_DATA].offset,
+                         elf->sec[ELF_SEC_DATA].size);
+            } else if (!strcmp(ELF_RODATA, name)) {
+                ESP_LOGD(TAG, ".rodata sec addr=0x%08x size=0x%08x offset=0x%08x",
+                         shdr[i].addr, shdr[i].size, shdr[i].offset);
+
+                elf->sec[ELF_SEC_RODATA].v_addr  = shdr[i].addr;
+                elf->sec[ELF_SEC_RODATA].size    = shdr[i].size;
+                elf->sec[ELF_SEC_RODATA].offset  = shdr[i].offset;
+
+                ESP_LOGD(TAG, ".rodata offset is 0x%lx size is 0x%x",
+                         elf->sec[ELF_SEC_RODATA].offset,
+                         elf->sec[ELF_SEC_RODATA].size);
+            } else if (!strcmp(ELF_DATA_REL_RO, name)) {
+                ESP_LOGD(TAG, ".data.rel.ro sec addr=0x%08x size=0x%08x offset=0x%08x",
+                         shdr[i].addr, shdr[i].size, shdr[i].offset);
+
+                elf->sec[ELF_SEC_DRLRO].v_addr  = shdr[i].addr;
+                elf->sec[ELF_SEC_DRLRO].size    = shdr[i].size;
+                elf->sec[ELF_SEC_DRLRO].offset  = shdr[i].offset;
+
+                ESP_LOGD(TAG, ".data.rel.ro offset is 0x%lx size is 0x%x",
+                         elf->sec[ELF_SEC_DRLRO].offset,
+                         elf->sec[ELF_SEC_DRLRO].size);
+            }
+        } else if (stype(&shdr[i], SHT_NOBITS) &&
+                   sflags(&shdr[i], SHF_ALLOC | SHF_WRITE) &&
+                   !strcmp(ELF_BSS, name)) {
+            ESP_LOGD(TAG, ".bss    sec addr=0x%08x size=0x%08x offset=0x%08x",
+                     shdr[i].addr, shdr[i].size, shdr[i].offset);
+
+            elf->sec[ELF_SEC_BSS].v_addr  = shdr[i].addr;
+            elf->sec[ELF_SEC_BSS].size    = shdr[i].size;
+            elf->sec[ELF_SEC_BSS].offset  = shdr[i].offset;
+
+            ESP_LOGD(TAG, ".bss    offset is 0x%lx size is 0x%x",
+                     elf->sec[ELF_SEC_BSS].offset,
+                     elf->sec[ELF_SEC_BSS].size);
+        }
+    }
+
+    /* No .text on image */
+
+    if (!elf->sec[ELF_SEC_TEXT].size) {
+        return -EINVAL;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Allocate memory for the scanned sections and assign their load addresses.
+ *
+ * ".data", ".rodata", ".data.rel.ro" and ".bss" share one R/W allocation,
+ * ".bss" is cleared. Section contents are not copied.
+ *
+ * @param elf - ELF object pointer
+ *
+ * @return ESP_OK if success or other if failed.
+ */
+
+static int esp_elf_alloc_sections(esp_elf_t *elf)
+{
+    uint32_t size;
+
+    /* Text that runs from elsewhere is only staged, it needs no executable memory */
+
+    elf->ptext = esp_elf_malloc((elf->sec[ELF_SEC_TEXT].size + 3) & ~3, !elf->text_run);
+    if (!elf->ptext) {
+        return -ENOMEM;
+    }
+
+    size = elf->sec[ELF_SEC_DATA].size +
+           elf->sec[ELF_SEC_RODATA].size +
+           elf->sec[ELF_SEC_BSS].size +
+           elf->sec[ELF_SEC_DRLRO].size;
+    if (size && elf->data_buf) {
+        if (size > elf->data_buf_size) {
+            esp_elf_free(elf->ptext);
+            elf->ptext = NULL;
+            return -ENOMEM;
+        }
+
+        elf->pdata = elf->data_buf;
+    } else if (size) {
+        elf->pdata = esp_elf_malloc(size, false);
+        if (!elf->pdata) {
+            esp_elf_free(elf->ptext);
+            elf->ptext = NULL;
+            return -ENOMEM;
+        }
+    }
+
+    elf->sec[ELF_SEC_TEXT].addr = (Elf32_Addr)elf->ptext;
+
+#ifdef CONFIG_ELF_LOADER_SET_MMU
+    if (esp_elf_arch_init_mmu(elf)) {
+        esp_elf_free(elf->ptext);
+        esp_elf_free(elf->pdata);
+        elf->ptext = NULL;
+        elf->pdata = NULL;
+        return -EIO;
+    }
+#endif
+
+    /**
+     * Place ".data", ".rodata" and ".bss" in R/W space memory.
+     *
+     * Todo: Place ".rodata" to rodata section by MMU/MPU.
+     */
+
+    if (size) {
+        uint8_t *pdata = elf->pdata;
+        const int order[] = { ELF_SEC_DATA, ELF_SEC_RODATA, ELF_SEC_DRLRO };
+
+        for (int i = 0; i < sizeof(order) / sizeof(order[0]); i++) {
+            if (elf->sec[order[i]].size) {
+                elf->sec[order[i]].addr = (uint32_t)pdata;
+                pdata += elf->sec[order[i]].size;
+            }
+        }
+
+        if (elf->sec[ELF_SEC_BSS].size) {
+            elf->sec[ELF_SEC_BSS].addr = (uint32_t)pdata;
+            memset(pdata, 0, elf->sec[ELF_SEC_BSS].size);
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Set ELF entry from the entry address in the ELF header.
+ *
+ * @param elf   - ELF object pointer
+ * @param entry - Entry virtual address
+ *
+ * @return None
+ */
+
+static void esp_elf_set_entry(esp_elf_t *elf, uint32_t entry)
+{
+    entry = esp_elf_run_addr(elf, entry + elf->sec[ELF_SEC_TEXT].addr -
+                             elf->sec[ELF_SEC_TEXT].v_addr);
+
+#ifdef CONFIG_ELF_LOADER_CACHE_OFFSET
+    elf->entry = (void *)elf_remap_text(elf, (uintptr_t)entry);
+#else
+    elf->entry = (void *)entry;
+#endif
+}
+
+/**
+ * @brief Load ELF section.
+ *
+ * @param elf - ELF object pointer
+ * @param pbuf - ELF data buffer
+ *
+ * @return ESP_OK if success or other if failed.
+ */
+
+static int esp_elf_load_section(esp_elf_t *elf, const uint8_t *pbuf)
+{
+    int ret;
+
+    const elf32_hdr_t *ehdr = (const elf32_hdr_t *)pbuf;
+    const elf32_shdr_t *shdr = (const elf32_shdr_t *)(pbuf + ehdr->shoff);
+    const char *shstrab = (const char *)pbuf + shdr[ehdr->shstrndx].offset;
+
+    ret = esp_elf_scan_sections(elf, shdr, ehdr->shnum, shstrab);
+    if (ret) {
+        return ret;
+    }
+
+    ret = esp_elf_alloc_sections(elf);
+    if (ret) {
+        return ret;
+    }
+
+    /* Dump ".text", ".data", ".rodata" and ".data.rel.ro" from ELF to memory */
+
+    for (int i = 0; i < ELF_SECS; i++) {
+        if (i != ELF_SEC_BSS && elf->sec[i].size) {
+            memcpy((void *)elf->sec[i].addr, pbuf + elf->sec[i].offset,
+                   elf->sec[i].size);
+        }
+    }
+
+    esp_elf_set_entry(elf, ehdr->entry);
+
+    return 0;
+}
+
+#else
+
+/**
+ * @brief Load ELF segment.
+ *
+ * @param elf - ELF object pointer
+ * @param pbuf - ELF data buffer
+ *
+ * @return ESP_OK if success or other if failed.
+ */
+
+static int esp_elf_load_segment(esp_elf_t *elf, const uint8_t *pbuf)
+{
+    uint32_t size;
+    bool first_segment = false;
+    Elf32_Addr vaddr_s = 0;
+    Elf32_Addr vaddr_e = 0;
+
+    const elf32_hdr_t *ehdr = (const elf32_hdr_t *)pbuf;
+    const elf32_phdr_t *phdr = (const elf32_phdr_t *)(pbuf + ehdr->phoff);
+
+    for (int i = 0; i < ehdr->phnum; i++) {
+        if (phdr[i].type != PT_LOAD) {
+            continue;
+        }
+
+        if (phdr[i].memsz < phdr[i].filesz) {
+            ESP_LOGE(TAG, "Invalid segment[%d], memsz: %d, filesz: %d",
+                     i, phdr[i].memsz, phdr[i].filesz);
+            return -EINVAL;
+        }
+
+        if (first_segment == true) {
+            vaddr_s = phdr[i].vaddr;
+            vaddr_e = phdr[i].vaddr + phdr[i].memsz;
+            first_segment = true;
+            if (vaddr_e < vaddr_s) {
+                ESP_LOGE(TAG, "Invalid segment[%d], vaddr: 0x%x, memsz: %d",
+                         i, phdr[i].vaddr, phdr[i].memsz);
+                return -EINVAL;
+            }
+        } else {
+            if (phdr[i].vaddr < vaddr_e) {
+                ESP_LOGE(TAG, "Invalid segment[%d], should not overlap, vaddr: 0x%x, vaddr_e: 0x%x\n",
+                         i, phdr[i].vaddr, vaddr_e);
+                return -EINVAL;
+            }
+
+            if (phdr[i].vaddr > vaddr_e + ADDR_OFFSET) {
+                ESP_LOGI(TAG, "Too much padding before segment[%d], padding: %d",
+                         i, phdr[i].vaddr - vaddr_e);
+            }
+
+            vaddr_e = phdr[i].vaddr + phdr[i].memsz;
+            if (vaddr_e < phdr[i].vaddr) {
+                ESP_LOGE(TAG, "Invalid segment[%d], address overflow, vaddr: 0x%x, vaddr_e: 0x%x\n",
+                         i, phdr[i].vaddr, vaddr_e);
+                return -EINVAL;
+            }
+        }
+
+        ESP_LOGD(TAG, "LOAD segment[%d], vaddr: 0x%x, memsize: 0x%08x",
+                 i, phdr[i].vaddr, phdr[i].memsz);
+    }
+
+    size = vaddr_e - vaddr_s;
+    if (size == 0) {
+        return -EINVAL;
+    }
+
+    elf->svaddr = vaddr_s;
+    elf->psegment = esp_elf_malloc(size, true);
+    if (!elf->psegment) {
+        return -ENOMEM;
+    }
+
+    memset(elf->psegment, 0, size);
+
+    /* Dump "PT_LOAD" from ELF to memory space */
+
+    for (int i = 0; i < ehdr->phnum; i++) {
+        if (phdr[i].type == PT_LOAD) {
+            memcpy(elf->psegment + phdr[i].vaddr - vaddr_s,
+                   (uint8_t *)pbuf + phdr[i].offset, phdr[i].filesz);
+            ESP_LOGD(TAG, "Copy segment[%d], mem_addr: 0x%x, vaddr: 0x%x, size: 0x%08x",
+                     i, (int)((uint8_t *)elf->psegment + phdr[i].vaddr - vaddr_s),
+                     phdr[i].vaddr, phdr[i].filesz);
+        }
+    }
+
+#if SOC_CACHE_INTERNAL_MEM_VIA_L1CACHE
+    cache_ll_writeback_all(CACHE_LL_LEVEL_INT_MEM, CACHE_TYPE_DATA, CACHE_LL_ID_ALL);
+#endif
+
+    elf->entry = (void *)((uint8_t *)elf->psegment + ehdr->entry - vaddr_s);
+
+    return 0;
+}
+#endif
+
+/**
+ * @brief Map symbol's address of ELF to physic space.
+ *
+ * @param elf - ELF object pointer
+ * @param sym - ELF symbol address
+ *
+ * @return ESP_OK if success or other if failed.
+ */
+uintptr_t esp_elf_map_sym(esp_elf_t *elf, uintptr_t sym)
+{
+    for (int i = 0; i < ELF_SECS; i++) {
+        if ((sym >= elf->sec[i].v_addr) &&
+                (sym < (elf->sec[i].v_addr + elf->sec[i].size))) {
+            return sym - elf->sec[i].v_addr + elf->sec[i].addr;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Translate a loaded ".text" address to the address it runs from.
+ *
+ * Only differs from the input when the ELF object has a text_run address,
+ * addresses outside of ".text" are returned unchanged.
+ *
+ * @param elf  - ELF object pointer
+ * @param addr - Address in the loaded image
+ *
+ * @return Address to use in relocated code and data
+ */
+uintptr_t esp_elf_run_addr(esp_elf_t *elf, uintptr_t addr)
+{
+    const esp_elf_sec_t *sec = &elf->sec[ELF_SEC_TEXT];
+
+    if (elf->text_run && addr >= sec->addr && addr < sec->addr + sec->size) {
+        return addr - sec->addr + elf->text_run;
+    }
+
+    return addr;
+}
+
+/**
+ * @brief Free the memory holding the loaded sections of ELF.
+ *
+ * @param elf - ELF object pointer
+ *
+ * @return None
+ */
+static void esp_elf_free_sections(esp_elf_t *elf)
+{
+#if CONFIG_ELF_LOADER_BUS_ADDRESS_MIRROR
+    if (elf->pdata != elf->data_buf) {
+        esp_elf_free(elf->pdata);
+    }
+    esp_elf_free(elf->ptext);
+    elf->pdata = NULL;
+    elf->ptext = NULL;
+#else
+    esp_elf_free(elf->psegment);
+    elf->psegment = NULL;
+#endif
+}
+
+/**
+ * @brief Append a resolved relocation target to a prelink table.
+ *
+ * @param pl    - Prelink table in record mode
+ * @param kind  - ELF_FIXUP_* kind
+ * @param value - Absolute or ELF virtual address
+ *
+ * @return ESP_OK if success or other if failed.
+ */
+static int esp_elf_prelink_add(esp_elf_prelink_t *pl, uint32_t kind, uint32_t value)
+{
+    if (pl->count == pl->capacity) {
+        uint32_t capacity = pl->capacity ? pl->capacity * 2 : 64;
+        esp_elf_fixup_t *fixups = realloc(pl->fixups, capacity * sizeof(esp_elf_fixup_t));
+
+        if (!fixups) {
+            return -ENOMEM;
+        }
+
+        pl->fixups = fixups;
+        pl->capacity = capacity;
+    }
+
+    pl->fixups[pl->count].kind = kind;
+    pl->fixups[pl->count].value = value;
+    pl->count++;
+
+    return 0;
+}
+
+/**
+ * @brief Apply a block of relocation entries from a prelink table.
+ *
+ * No symbol table is needed: every target was resolved when the table
+ * was recorded, only ELF virtual addresses are mapped again.
+ *
+ * @param elf      - ELF object pointer, elf->prelink in apply mode
+ * @param rela     - Relocation entries, need not be aligned
+ * @param nr_reloc - Number of relocation entries
+ *
+ * @return ESP_OK if success or other if failed.
+ */
+static int esp_elf_relocate_prelinked(esp_elf_t *elf, const elf32_rela_t *rela, uint32_t nr_reloc)
+{
+    esp_elf_prelink_t *pl = elf->prelink;
+    const elf32_sym_t sym = { 0 };
+
+    if (pl->pos + nr_reloc > pl->count) {
+        ESP_LOGE(TAG, "Prelink table does not match the file");
+        return -EINVAL;
+    }
+
+    for (uint32_t i = 0; i < nr_reloc; i++) {
+        elf32_rela_t rela_buf;
+        const esp_elf_fixup_t *fixup = &pl->fixups[pl->pos++];
+        uintptr_t addr = fixup->value;
+
+        memcpy(&rela_buf, &rela[i], sizeof(elf32_rela_t));
+
+        if (fixup->kind == ELF_FIXUP_MAP) {
+            addr = esp_elf_map_sym(elf, addr);
+        }
+
+        esp_elf_arch_relocate(elf, &rela_buf, &sym, addr);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Prepare the symbol cache for another symbol table.
+ *
+ * Without memory the cache stays empty and every symbol is looked up.
+ *
+ * @param cache - Symbol cache
+ * @param count - Number of symbols in the table
+ *
+ * @return Bytes held by the cache.
+ */
+static uint32_t esp_elf_symcache_reset(esp_elf_symcache_t *cache, uint32_t count)
+{
+    free(cache->addr);
+    cache->addr = calloc(count, sizeof(uintptr_t));
+    cache->count = cache->addr ? count : 0;
+
+    return cache->count * sizeof(uintptr_t);
+}
+
+/**
+ * @brief Find an external symbol, each symbol table index is resolved once per load.
+ *
+ * @param elf   - ELF object, its scope is searched after the global tables
+ * @param cache - Symbol cache
+ * @param idx   - Index of the symbol in its symbol table
+ * @param name  - Symbol name
+ *
+ * @return Symbol address if success or 0 if failed.
+ */
+static uintptr_t esp_elf_symcache_find(const esp_elf_t *elf, esp_elf_symcache_t *cache,
+                                       uint32_t idx, const char *name)
+{
+    uintptr_t addr;
+
+    if (idx < cache->count && cache->addr[idx]) {
+#ifndef NDEBUG
+        cache->hits++;
+#endif
+        return cache->addr[idx];
+    }
+
+    addr = elf_find_sym_scope(name, elf->scope, elf->scope_count);
+#ifndef NDEBUG
+    cache->lookups++;
+#endif
+    if (idx < cache->count) {
+        cache->addr[idx] = addr;
+    }
+
+    return addr;
+}
+
+/**
+ * @brief Log how often the symbol cache saved a lookup, debug builds only.
+ *
+ * @param cache - Symbol cache
+ *
+ * @return None
+ */
+static void esp_elf_symcache_report(const esp_elf_symcache_t *cache)
+{
+#ifndef NDEBUG
+    ESP_LOGI(TAG, "Symbols: %u lookups, %u cache hits",
+             (unsigned)cache->lookups, (unsigned)cache->hits);
+#endif
+}
+
+/**
+ * @brief Resolve and apply a block of relocation entries.
+ *
+ * @param elf      - ELF object pointer
+ * @param rela     - Relocation entries, need not be aligned
+ * @param nr_reloc - Number of relocation entries
+ * @param symtab   - Symbol table the entries refer to
+ * @param strtab   - String table of the symbol table
+ * @param cache    - Symbols of symtab resolved so far
+ *
+ * @return ESP_OK if success or other if failed.
+ */
+static int esp_elf_relocate_rela(esp_elf_t *elf, const elf32_rela_t *rela, uint32_t nr_reloc,
+                                 const elf32_sym_t *symtab, const char *strtab,
+                                 esp_elf_symcache_t *cache)
+{
+    esp_elf_prelink_t *pl = elf->prelink;
+
+    if (pl && !pl->record) {
+        return esp_elf_relocate_prelinked(elf, rela, nr_reloc);
+    }
+
+    for (int i = 0; i < nr_reloc; i++) {
+        int type;
+        uintptr_t addr = 0;
+        elf32_rela_t rela_buf;
+
+        memcpy(&rela_buf, &rela[i], sizeof(elf32_rela_t));
+
+        const elf32_sym_t *sym = &symtab[ELF_R_SYM(rela_buf.info)];
+
+        type = ELF_R_TYPE(rela_buf.info);
+        if (type == STT_COMMON || type == STT_OBJECT || type == STT_SECTION) {
+            const char *comm_name = strtab + sym->name;
+
+            if (comm_name[0]) {
+                addr = esp_elf_symcache_find(elf, cache, ELF_R_SYM(rela_buf.info), comm_name);
+
+                if (!addr) {
+                    ESP_LOGE(TAG, "Can't find common %s", strtab + sym->name);
+                    return -ENOSYS;
+                }
+
+                ESP_LOGD(TAG, "Find common %s addr=%x", comm_name, addr);
+            }
+        } else if (type == STT_FILE) {
+            const char *func_name = strtab + sym->name;
+
+            if (sym->value) {
+                addr = esp_elf_map_sym(elf, sym->value);
+            } else {
+                addr = esp_elf_symcache_find(elf, cache, ELF_R_SYM(rela_buf.info), func_name);
+				ESP_LOGI(TAG, "Find symbol %s addr=%x", func_name, addr);
+            }
+
+            if (!addr) {
+                ESP_LOGE(TAG, "Can't find symbol %s", func_name);
+                return -ENOSYS;
+            }
+
+            ESP_LOGD(TAG, "Find function %s addr=%x", func_name, addr);
+        }
+
+        if (pl) {
+            int ret = esp_elf_prelink_add(pl, type == STT_FILE && sym->value ? ELF_FIXUP_MAP :
+                                          addr ? ELF_FIXUP_ABS : ELF_FIXUP_NONE,
+                                          type == STT_FILE && sym->value ? sym->value : addr);
+            if (ret) {
+                return ret;
+            }
+        }
+
+        esp_elf_arch_relocate(elf, &rela_buf, sym, addr);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Initialize ELF object.
+ *
+ * @param elf - ELF object pointer
+ *
+ * @return ESP_OK if success or other if failed.
+ */
+int esp_elf_init(esp_elf_t *elf)
+{
+    ESP_LOGI(TAG, "ELF loader version: %d.%d.%d", ELF_LOADER_VER_MAJOR, ELF_LOADER_VER_MINOR, ELF_LOADER_VER_PATCH);
+
+    if (!elf) {
+        return -EINVAL;
+    }
+
+    memset(elf, 0, sizeof(esp_elf_t));
+
+    return 0;
+}
+
+/**
+ * @brief Decode and relocate ELF data.
+ *
+ * @param elf - ELF object pointer
+ * @param pbuf - ELF data buffer
+ *
+ * @return ESP_OK if success or other if failed.
+ */
+int esp_elf_relocate(esp_elf_t *elf, const uint8_t *pbuf)
+{
+    int ret;
+
+    const elf32_hdr_t *ehdr;
+    const elf32_shdr_t *shdr;
+    const char *shstrab;
+
+    if (!elf || !pbuf) {
+        return -EINVAL;
+    }
+
+    ehdr    = (const elf32_hdr_t *)pbuf;
+    shdr    = (const elf32_shdr_t *)(pbuf + ehdr->shoff);
+    shstrab = (const char *)pbuf + shdr[ehdr->shstrndx].offset;
+
+    /* Load section or segment to memory space */
+
+#if CONFIG_ELF_LOADER_BUS_ADDRESS_MIRROR
+    ret = esp_elf_load_section(elf, pbuf);
+#else
+    ret = esp_elf_load_segment(elf, pbuf);
+#endif
+
+    if (ret) {
+        ESP_LOGE(TAG, "Error to load elf file, ret=%d", ret);
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "elf->entry=%p\n", elf->entry);
+
+    /* Relocation section data */
+
+    esp_elf_symcache_t cache = { 0 };
+    uint32_t cache_link = 0;
+
+    for (uint32_t i = 0; i < ehdr->shnum; i++) {
+        if (stype(&shdr[i], SHT_RELA)) {
+            uint32_t nr_reloc;
+            const elf32_rela_t *rela;
+            const elf32_sym_t *symtab;
+            const char *strtab;
+
+            nr_reloc = shdr[i].size / sizeof(elf32_rela_t);
+            rela     = (const elf32_rela_t *)(pbuf + shdr[i].offset);
+            symtab   = (const elf32_sym_t *)(pbuf + shdr[shdr[i].link].offset);
+            strtab   = (const char *)(pbuf + shdr[shdr[shdr[i].link].link].offset);
+
+            ESP_LOGD(TAG, "Section %s has %d symbol tables", shstrab + shdr[i].name, (int)nr_reloc);
+
+            if (!cache.addr || cache_link != shdr[i].link) {
+                cache_link = shdr[i].link;
+                esp_elf_symcache_reset(&cache, shdr[cache_link].size / sizeof(elf32_sym_t));
+            }
+
+            ret = esp_elf_relocate_rela(elf, rela, nr_reloc, symtab, strtab, &cache);
+            if (ret) {
+                free(cache.addr);
+                esp_elf_free_sections(elf);
+                return ret;
+            }
+        }
+    }
+
+    esp_elf_symcache_report(&cache);
+    free(cache.addr);
+
+    if (elf->prelink && !elf->prelink->record && elf->prelink->pos != elf->prelink->count) {
+        ESP_LOGE(TAG, "Prelink table does not match the file");
+        esp_elf_free_sections(elf);
+        return -EINVAL;
+    }
+
+#ifdef CONFIG_ELF_LOADER_LOAD_PSRAM
+    esp_elf_arch_flush();
+#endif
+
+    return 0;
+}
+
+#if CONFIG_ELF_LOADER_BUS_ADDRESS_MIRROR
+
+/**
+ * @brief Read a block of the ELF file.
+ *
+ * @param fp     - ELF file
+ * @param offset - File offset
+ * @param buf    - Destination buffer
+ * @param len    - Number of bytes
+ *
+ * @return ESP_OK if success or other if failed.
+ */
+static int esp_elf_fread(FILE *fp, uint32_t offset, void *buf, uint32_t len)
+{
+    if (fseek(fp, offset, SEEK_SET) || fread(buf, 1, len, fp) != len) {
+        return -EIO;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Stream the ".text" section of the ELF file into its load address.
+ *
+ * Executable memory may only be written with 32-bit accesses, so data
+ * goes through a word aligned bounce buffer and is copied word by word.
+ * The allocation of ".text" is rounded up to whole words for this.
+ * Other sections are packed without alignment and must be read directly.
+ *
+ * @param fp     - ELF file
+ * @param sec    - Section to load, addr/offset/size must be set
+ * @param bounce - Bounce buffer
+ * @param size   - Bounce buffer size in bytes, multiple of 4
+ *
+ * @return ESP_OK if success or other if failed.
+ */
+static int esp_elf_fread_section(FILE *fp, const esp_elf_sec_t *sec, uint32_t *bounce, uint32_t size)
+{
+    uint32_t *dst = (uint32_t *)sec->addr;
+    uint32_t done = 0;
+
+    if (fseek(fp, sec->offset, SEEK_SET)) {
+        return -EIO;
+    }
+
+    while (done < sec->size) {
+        uint32_t n = MIN(size, sec->size - done);
+        uint32_t words = (n + 3) / 4;
+
+        /* The last word may extend beyond the section in the file, keep it defined */
+
+        bounce[words - 1] = 0;
+        if (fread(bounce, 1, n, fp) != n) {
+            return -EIO;
+        }
+
+        for (uint32_t i = 0; i < words; i++) {
+            *dst++ = bounce[i];
+        }
+
+        done += n;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Load one table of the ELF file into a temporary allocation.
+ *
+ * @param fp    - ELF file
+ * @param shdr  - Section header of the table
+ * @param stats - Load statistics, the allocation is accounted here
+ *
+ * @return Table pointer if success or NULL if failed.
+ */
+static void *esp_elf_fread_table(FILE *fp, const elf32_shdr_t *shdr, esp_elf_load_stats_t *stats)
+{
+    void *ptr = malloc(shdr->size + 1);
+
+    if (!ptr) {
+        return NULL;
+    }
+
+    if (esp_elf_fread(fp, shdr->offset, ptr, shdr->size)) {
+        free(ptr);
+        return NULL;
+    }
+
+    /* Terminate string tables even if the file is truncated */
+
+    ((char *)ptr)[shdr->size] = '\0';
+    stats->cur_bytes += shdr->size + 1;
+    stats->peak_bytes = MAX(stats->peak_bytes, stats->cur_bytes);
+
+    return ptr;
+}
+
+/**
+ * @brief Drop a table loaded by esp_elf_fread_table.
+ */
+static void esp_elf_free_table(void *ptr, const elf32_shdr_t *shdr, esp_elf_load_stats_t *stats)
+{
+    if (ptr) {
+        free(ptr);
+        stats->cur_bytes -= shdr->size + 1;
+    }
+}
+
+/**
+ * @brief Decode and relocate ELF data directly from a file.
+ *
+ * Only the ELF header, the section header table and the symbol tables are
+ * kept in RAM while loading. Sections are streamed into their final
+ * allocation and relocation entries are processed in blocks of
+ * CONFIG_ELF_LOADER_STREAM_CHUNK entries, so peak memory is roughly the
+ * size of the loaded image instead of the file size plus the image.
+ *
+ * @param elf   - ELF object pointer
+ * @param fp    - ELF file opened for binary reading
+ * @param stats - Optional load time and peak memory report
+ *
+ * @return ESP_OK if success or other if failed.
+ */
+int esp_elf_relocate_file(esp_elf_t *elf, FILE *fp, esp_elf_load_stats_t *stats)
+{
+    int ret;
+    elf32_hdr_t ehdr;
+    elf32_shdr_t *shdr = NULL;
+    char *shstrab = NULL;
+    elf32_sym_t *symtab = NULL;
+    char *strtab = NULL;
+    uint32_t sym_idx = 0;
+    uint32_t *chunk = NULL;
+    esp_elf_symcache_t cache = { 0 };
+    esp_elf_load_stats_t local_stats;
+    int64_t start = esp_timer_get_time();
+
+    if (!elf || !fp) {
+        return -EINVAL;
+    }
+
+    if (!stats) {
+        stats = &local_stats;
+    }
+
+    memset(stats, 0, sizeof(esp_elf_load_stats_t));
+
+    /* Read headers and section names */
+
+    ret = esp_elf_fread(fp, 0, &ehdr, sizeof(ehdr));
+    if (ret) {
+        goto exit;
+    }
+
+    if (ehdr.ident[0] != 0x7f || ehdr.shentsize != sizeof(elf32_shdr_t) ||
+            ehdr.shstrndx >= ehdr.shnum) {
+        ret = -EINVAL;
+        goto exit;
+    }
+
+    shdr = malloc(ehdr.shnum * sizeof(elf32_shdr_t));
+    if (!shdr) {
+        ret = -ENOMEM;
+        goto exit;
+    }
+
+    stats->cur_bytes = ehdr.shnum * sizeof(elf32_shdr_t);
+
+    ret = esp_elf_fread(fp, ehdr.shoff, shdr, ehdr.shnum * sizeof(elf32_shdr_t));
+    if (ret) {
+        goto exit;
+    }
+
+    shstrab = esp_elf_fread_table(fp, &shdr[ehdr.shstrndx], stats);
+    if (!shstrab) {
+        ret = -ENOMEM;
+        goto exit;
+    }
+
+    /* Allocate the image and stream the sections into it */
+
+    ret = esp_elf_scan_sections(elf, shdr, ehdr.shnum, shstrab);
+    if (ret) {
+        goto exit;
+    }
+
+    ret = esp_elf_alloc_sections(elf);
+    if (ret) {
+        goto exit;
+    }
+
+    for (int i = 0; i < ELF_SECS; i++) {
+        stats->cur_bytes += elf->sec[i].size;
+    }
+
+    chunk = malloc(CONFIG_ELF_LOADER_STREAM_CHUNK * sizeof(elf32_rela_t));
+    if (!chunk) {
+        ret = -ENOMEM;
+        goto exit;
+    }
+
+    stats->cur_bytes += CONFIG_ELF_LOADER_STREAM_CHUNK * sizeof(elf32_rela_t);
+    stats->peak_bytes = MAX(stats->peak_bytes, stats->cur_bytes);
+
+    for (int i = 0; i < ELF_SECS; i++) {
+        if (i == ELF_SEC_BSS || !elf->sec[i].size) {
+            continue;
+        }
+
+        if (i == ELF_SEC_TEXT) {
+            ret = esp_elf_fread_section(fp, &elf->sec[i], chunk,
+                                        CONFIG_ELF_LOADER_STREAM_CHUNK * sizeof(elf32_rela_t));
+            if (ret) {
+                goto exit;
+            }
+        } else if (fseek(fp, elf->sec[i].offset, SEEK_SET) ||
+                   fread((void *)elf->sec[i].addr, 1, elf->sec[i].size, fp) != elf->sec[i].size) {
+            ret = -EIO;
+            goto exit;
+        }
+    }
+
+    esp_elf_set_entry(elf, ehdr.entry);
+
+    ESP_LOGI(TAG, "elf->entry=%p\n", elf->entry);
+
+    /* Relocation section data, the symbol tables are loaded once per table */
+
+    for (uint32_t i = 0; i < ehdr.shnum; i++) {
+        if (!stype(&shdr[i], SHT_RELA)) {
+            continue;
+        }
+
+        uint32_t link = shdr[i].link;
+        uint32_t nr_reloc = shdr[i].size / sizeof(elf32_rela_t);
+
+        if (link >= ehdr.shnum || shdr[link].link >= ehdr.shnum) {
+            ret = -EINVAL;
+            goto exit;
+        }
+
+        if (elf->prelink && !elf->prelink->record) {
+            /* Prelinked: targets come from the table, no symbol lookup */
+        } else if (!symtab || sym_idx != link) {
+            esp_elf_free_table(symtab, &shdr[sym_idx], stats);
+            esp_elf_free_table(strtab, &shdr[shdr[sym_idx].link], stats);
+            strtab = NULL;
+
+            sym_idx = link;
+            symtab = esp_elf_fread_table(fp, &shdr[link], stats);
+            strtab = symtab ? esp_elf_fread_table(fp, &shdr[shdr[link].link], stats) : NULL;
+            if (!strtab) {
+                ret = -ENOMEM;
+                goto exit;
+            }
+
+            stats->cur_bytes -= cache.count * sizeof(uintptr_t);
+            stats->cur_bytes += esp_elf_symcache_reset(&cache, shdr[link].size / sizeof(elf32_sym_t));
+            stats->peak_bytes = MAX(stats->peak_bytes, stats->cur_bytes);
+        }
+
+        ESP_LOGD(TAG, "Section %s has %d symbol tables", shstrab + shdr[i].name, (int)nr_reloc);
+
+        for (uint32_t done = 0; done < nr_reloc; ) {
+            uint32_t n = MIN(CONFIG_ELF_LOADER_STREAM_CHUNK, nr_reloc - done);
+
+            ret = esp_elf_fread(fp, shdr[i].offset + done * sizeof(elf32_rela_t),
+                                chunk, n * sizeof(elf32_rela_t));
+            if (ret) {
+                goto exit;
+            }
+
+            ret = esp_elf_relocate_rela(elf, (const elf32_rela_t *)chunk, n, symtab, strtab, &cache);
+            if (ret) {
+                goto exit;
+            }
+
+            done += n;
+        }
+    }
+
+    if (elf->prelink && !elf->prelink->record && elf->prelink->pos != elf->prelink->count) {
+        ESP_LOGE(TAG, "Prelink table does not match the file");
+        ret = -EINVAL;
+        goto exit;
+    }
+
+#ifdef CONFIG_ELF_LOADER_LOAD_PSRAM
+    esp_elf_arch_flush();
+#endif
+
+exit:
+    if (ret) {
+        ESP_LOGE(TAG, "Error to load elf file, ret=%d", ret);
+        esp_elf_free_sections(elf);
+    }
+
+    if (!ret) {
+        esp_elf_symcache_report(&cache);
+    }
+
+    free(cache.addr);
+    free(symtab);
+    free(strtab);
+    free(chunk);
+    free(shstrab);
+    free(shdr);
+
+    stats->load_us = (uint32_t)(esp_timer_get_time() - start);
+    stats->cur_bytes = 0;
+
+    ESP_LOGI(TAG, "Streamed in %u us, peak %u bytes",
+             (unsigned)stats->load_us, (unsigned)stats->peak_bytes);
+
+    return ret;
+}
+
+static int esp_elf_sym_cmp(const void *a, const void *b)
+{
+    return strcmp(((const struct esp_elfsym *)a)->name, ((const struct esp_elfsym *)b)->name);
+}
+
+/**
+ * @brief Collect the symbols an ELF defines in its dynamic symbol table.
+ *
+ * The addresses are mapped into the image that was loaded from the file, so
+ * the table stays valid until the ELF object is deinitialized. Names and
+ * entries share one allocation that is released with free(). The table is
+ * sorted by name, so it can be used as an esp_elfsym_scope.
+ *
+ * @param elf  - ELF object relocated from fp
+ * @param fp   - The same ELF file
+ * @param syms - Filled with a table terminated by ESP_ELFSYM_END
+ *
+ * @return Number of exported symbols if success or negative errno if failed.
+ */
+int esp_elf_export_symbols(esp_elf_t *elf, FILE *fp, struct esp_elfsym **syms)
+{
+    int ret;
+    elf32_hdr_t ehdr;
+    elf32_shdr_t *shdr = NULL;
+    elf32_sym_t *dynsym = NULL;
+    char *dynstr = NULL;
+    uint32_t dyn_idx = 0;
+    esp_elf_load_stats_t stats;
+
+    if (!elf || !fp || !syms) {
+        return -EINVAL;
+    }
+
+    *syms = NULL;
+    memset(&stats, 0, sizeof(stats));
+
+    ret = esp_elf_fread(fp, 0, &ehdr, sizeof(ehdr));
+    if (ret) {
+        return ret;
+    }
+
+    if (ehdr.ident[0] != 0x7f || ehdr.shentsize != sizeof(elf32_shdr_t)) {
+        return -EINVAL;
+    }
+
+    shdr = malloc(ehdr.shnum * sizeof(elf32_shdr_t));
+    if (!shdr) {
+        return -ENOMEM;
+    }
+
+    ret = esp_elf_fread(fp, ehdr.shoff, shdr, ehdr.shnum * sizeof(elf32_shdr_t));
+    if (ret) {
+        goto exit;
+    }
+
+    for (uint32_t i = 0; i < ehdr.shnum; i++) {
+        if (stype(&shdr[i], SHT_SYNSYM)) {
+            dyn_idx = i;
+            break;
+        }
+    }
+
+    if (!dyn_idx || shdr[dyn_idx].link >= ehdr.shnum) {
+        ret = -ENOENT;
+        goto exit;
+    }
+
+    dynsym = esp_elf_fread_table(fp, &shdr[dyn_idx], &stats);
+    dynstr = dynsym ? esp_elf_fread_table(fp, &shdr[shdr[dyn_idx].link], &stats) : NULL;
+    if (!dynstr) {
+        ret = -ENOMEM;
+        goto exit;
+    }
+
+    /* Count defined global symbols and the space for their names */
+
+    uint32_t nr_sym = shdr[dyn_idx].size / sizeof(elf32_sym_t);
+    uint32_t count = 0;
+    size_t names = 0;
+
+    for (uint32_t i = 0; i < nr_sym; i++) {
+        const elf32_sym_t *sym = &dynsym[i];
+        int bind = ELF_ST_BIND(sym->info);
+        int type = ELF_ST_TYPE(sym->info);
+
+        if (sym->shndx && sym->name < shdr[shdr[dyn_idx].link].size && dynstr[sym->name] &&
+                (bind == STB_GLOBAL || bind == STB_WEAK) && (type == STT_FUNC || type == STT_OBJECT)) {
+            count++;
+            names += strlen(dynstr + sym->name) + 1;
+        }
+    }
+
+    struct esp_elfsym *table = malloc((count + 1) * sizeof(struct esp_elfsym) + names);
+    if (!table) {
+        ret = -ENOMEM;
+        goto exit;
+    }
+
+    char *name = (char *)&table[count + 1];
+    uint32_t n = 0;
+
+    for (uint32_t i = 0; i < nr_sym && n < count; i++) {
+        const elf32_sym_t *sym = &dynsym[i];
+        int bind = ELF_ST_BIND(sym->info);
+        int type = ELF_ST_TYPE(sym->info);
+
+        if (sym->shndx && sym->name < shdr[shdr[dyn_idx].link].size && dynstr[sym->name] &&
+                (bind == STB_GLOBAL || bind == STB_WEAK) && (type == STT_FUNC || type == STT_OBJECT)) {
+            strcpy(name, dynstr + sym->name);
+            table[n].name = name;
+            table[n].sym = (const void *)esp_elf_map_sym(elf, sym->value);
+            name += strlen(name) + 1;
+            n++;
+        }
+    }
+
+    table[n].name = NULL;
+    table[n].sym = NULL;
+    qsort(table, n, sizeof(struct esp_elfsym), esp_elf_sym_cmp);
+    *syms = table;
+    ret = n;
+
+exit:
+    free(dynsym);
+    free(dynstr);
+    free(shdr);
+
+    return ret;
+}
+
+#else
+
+int esp_elf_relocate_file(esp_elf_t *elf, FILE *fp, esp_elf_load_stats_t *stats)
+{
+    return -ENOTSUP;
+}
+
+int esp_elf_export_symbols(esp_elf_t *elf, FILE *fp, struct esp_elfsym **syms)
+{
+    return -ENOTSUP;
+}
+
+#endif
+
+/**
+ * @brief Request running relocated ELF function.
+ *
+ * @param elf  - ELF object pointer
+ * @param opt  - Request options
+ * @param argc - Arguments number
+ * @param argv - Arguments value array
+ *
+ * @return ESP_OK if success or other if failed.
+ */
+int esp_elf_request(esp_elf_t *elf, int opt, int argc, char *argv[])
+{
+    if (!elf || !(elf->entry)) {
+        return -EINVAL;
+    }
+
+    elf->entry(argc, argv);
+
+    return 0;
+}
+
+/**
+ * @brief Deinitialize ELF object.
+ *
+ * @param elf - ELF object pointer
+ *
+ * @return None
+ */
+void esp_elf_deinit(esp_elf_t *elf)
+{
+#if CONFIG_ELF_LOADER_BUS_ADDRESS_MIRROR
+    if (elf->pdata) {
+        if (elf->pdata != elf->data_buf) {
+            esp_elf_free(elf->pdata);
+        }
+        elf->pdata = NULL;
+    }
+
+    if (elf->ptext) {
+        esp_elf_free(elf->ptext);
+        elf->ptext = NULL;
+    }
+#else
+    if (elf->psegment) {
+        esp_elf_free(elf->ptext);
+        elf->ptext = NULL;
+    }
+#endif
+
+#ifdef CONFIG_ELF_LOADER_SET_MMU
+    esp_elf_arch_deinit_mmu(elf);
+#endif
+}
+
+/**
+ * @brief Print header description information of ELF.
+ *
+ * @param pbuf - ELF data buffer
+ *
+ * @return None
+ */
+void esp_elf_print_ehdr(const uint8_t *pbuf)
+{
+    const char *s_bits, *s_endian;
+    const elf32_hdr_t *hdr = (const elf32_hdr_t *)pbuf;
+
+    switch (hdr->ident[4]) {
+    case 1:
+        s_bits = "32-bit";
+        break;
+    case 2:
+        s_bits = "64-bit";
+        break;
+    default:
+        s_bits = "invalid bits";
+        break;
+    }
+
+    switch (hdr->ident[5]) {
+    case 1:
+        s_endian = "little-endian";
+        break;
+    case 2:
+        s_endian = "big-endian";
+        break;
+    default:
+        s_endian = "invalid endian";
+        break;
+    }
+
+    if (hdr->ident[0] == 0x7f) {
+        ESP_LOGI(TAG, "%-40s %c%c%c", "Class:",                     hdr->ident[1], hdr->ident[2], hdr->ident[3]);
+    }
+
+    ESP_LOGI(TAG, "%-40s %s, %s", "Format:",                        s_bits, s_endian);
+    ESP_LOGI(TAG, "%-40s %x", "Version(current):",                  hdr->ident[6]);
+
+    ESP_LOGI(TAG, "%-40s %d", "Type:",                              hdr->type);
+    ESP_LOGI(TAG, "%-40s %d", "Machine:",                           hdr->machine);
+    ESP_LOGI(TAG, "%-40s %x", "Version:",                           hdr->version);
+    ESP_LOGI(TAG, "%-40s %x", "Entry point address:",               hdr->entry);
+    ESP_LOGI(TAG, "%-40s %x", "Start of program headers:",          hdr->phoff);
+    ESP_LOGI(TAG, "%-40s %d", "Start of section headers:",          hdr->shoff);
+    ESP_LOGI(TAG, "%-40s 0x%x", "Flags:",                           hdr->flags);
+    ESP_LOGI(TAG, "%-40s %d", "Size of this header(bytes):",        hdr->ehsize);
+    ESP_LOGI(TAG, "%-40s %d", "Size of program headers(bytes):",    hdr->phentsize);
+    ESP_LOGI(TAG, "%-40s %d", "Number of program headers:",         hdr->phnum);
+    ESP_LOGI(TAG, "%-40s %d", "Size of section headers(bytes):",    hdr->shentsize);
+    ESP_LOGI(TAG, "%-40s %d", "Number of section headers:",         hdr->shnum);
+    ESP_LOGI(TAG, "%-40s %d", "Section header string table i:",     hdr->shstrndx);
+}
+
+/**
+ * @brief Print program header description information of ELF.
+ *
+ * @param pbuf - ELF data buffer
+ *
+ * @return None
+ */
+void esp_elf_print_phdr(const uint8_t *pbuf)
+{
+    const elf32_hdr_t *ehdr = (const elf32_hdr_t *)pbuf;
+    const elf32_phdr_t *phdr = (const elf32_phdr_t *)((size_t)pbuf + ehdr->phoff);
+
+    for (int i = 0; i < ehdr->phnum; i++) {
+        ESP_LOGI(TAG, "%-40s %d", "type:",                          phdr->type);
+        ESP_LOGI(TAG, "%-40s 0x%x", "offset:",                      phdr->offset);
+        ESP_LOGI(TAG, "%-40s 0x%x", "vaddr",                        phdr->vaddr);
+        ESP_LOGI(TAG, "%-40s 0x%x", "paddr:",                       phdr->paddr);
+        ESP_LOGI(TAG, "%-40s %d", "filesz",                         phdr->filesz);
+        ESP_LOGI(TAG, "%-40s %d", "memsz",                          phdr->memsz);
+        ESP_LOGI(TAG, "%-40s %d", "flags",                          phdr->flags);
+        ESP_LOGI(TAG, "%-40s 0x%x", "align",                        phdr->align);
+
+        phdr = (const elf32_phdr_t *)((size_t)phdr + sizeof(elf32_phdr_t));
+    }
+}
+
+/**
+ * @brief Print section header description information of ELF.
+ *
+ * @param pbuf - ELF data buffer
+ *
+ * @return None
+ */
+void esp_elf_print_shdr(const uint8_t *pbuf)
+{
+    const elf32_hdr_t *ehdr = (const elf32_hdr_t *)pbuf;
+    const elf32_shdr_t *shdr = (const elf32_shdr_t *)((size_t)pbuf + ehdr->shoff);
+
+    for (int i = 0; i < ehdr->shnum; i++) {
+        ESP_LOGI(TAG, "%-40s %d", "name:",                          shdr->name);
+        ESP_LOGI(TAG, "%-40s %d", "type:",                          shdr->type);
+        ESP_LOGI(TAG, "%-40s 0x%x", "flags:",                       shdr->flags);
+        ESP_LOGI(TAG, "%-40s %x", "addr",                           shdr->addr);
+        ESP_LOGI(TAG, "%-40s %x", "offset:",                        shdr->offset);
+        ESP_LOGI(TAG, "%-40s %d", "size",                           shdr->size);
+        ESP_LOGI(TAG, "%-40s 0x%x", "link",                         shdr->link);
+        ESP_LOGI(TAG, "%-40s %d", "addralign",                      shdr->addralign);
+        ESP_LOGI(TAG, "%-40s %d", "entsize",                        shdr->entsize);
+
+        shdr = (const elf32_shdr_t *)((size_t)shdr + sizeof(elf32_shdr_t));
+    }
+}
+
+/**
+ * @brief Print section information of ELF.
+ *
+ * @param pbuf - ELF data buffer
+ *
+ * @return None
+ */
+void esp_elf_print_sec(esp_elf_t *elf)
+{
+    const char *sec_names[ELF_SECS] = {
+        "text", "bss", "data", "rodata"
+    };
+
+    for (int i = 0; i < ELF_SECS; i++) {
+        ESP_LOGI(TAG, "%s:   0x%08x size 0x%08x", sec_names[i], elf->sec[i].addr, elf->sec[i].size);
+    }
+
+    ESP_LOGI(TAG, "entry:  %p", elf->entry);
+}
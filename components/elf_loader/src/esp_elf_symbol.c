@@ -0,0 +1,531 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+#include <reent.h>
+#include <pthread.h>
+#include <setjmp.h>
+#include <getopt.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+#include <ctype.h>
+#include <stdbool.h>
+#include <sys/lock.h>
+
+#include "rom/ets_sys.h"
+#include "esp_log.h"
+
+#include "private/elf_symbol.h"
+
+static const char *TAG = "elf_symbol";
+
+extern int __ltdf2(double a, double b);
+extern unsigned int __fixunsdfsi(double a);
+extern int __gtdf2(double a, double b);
+extern double __floatunsidf(unsigned int i);
+extern double __divdf3(double a, double b);
+
+/** @brief Libc public functions symbols look-up table */
+
+static const struct esp_elfsym g_esp_libc_elfsyms[] = {
+
+    /* string.h */
+
+    ESP_ELFSYM_EXPORT(strerror),
+    ESP_ELFSYM_EXPORT(memset),
+    ESP_ELFSYM_EXPORT(memcpy),
+    ESP_ELFSYM_EXPORT(strlen),
+    ESP_ELFSYM_EXPORT(strtod),
+    ESP_ELFSYM_EXPORT(strrchr),
+    ESP_ELFSYM_EXPORT(strchr),
+    ESP_ELFSYM_EXPORT(strcmp),
+    ESP_ELFSYM_EXPORT(strtol),
+    ESP_ELFSYM_EXPORT(strcspn),
+    ESP_ELFSYM_EXPORT(strncat),
+
+    /* stdio.h */
+
+    ESP_ELFSYM_EXPORT(puts),
+    ESP_ELFSYM_EXPORT(putchar),
+    ESP_ELFSYM_EXPORT(fputc),
+    ESP_ELFSYM_EXPORT(fputs),
+    ESP_ELFSYM_EXPORT(printf),
+    ESP_ELFSYM_EXPORT(vfprintf),
+    ESP_ELFSYM_EXPORT(fprintf),
+    ESP_ELFSYM_EXPORT(fwrite),
+
+    /* unistd.h */
+
+    ESP_ELFSYM_EXPORT(usleep),
+    ESP_ELFSYM_EXPORT(sleep),
+    ESP_ELFSYM_EXPORT(exit),
+    ESP_ELFSYM_EXPORT(close),
+
+    /* stdlib.h */
+
+    ESP_ELFSYM_EXPORT(malloc),
+    ESP_ELFSYM_EXPORT(calloc),
+    ESP_ELFSYM_EXPORT(realloc),
+    ESP_ELFSYM_EXPORT(free),
+
+    /* time.h */
+
+    ESP_ELFSYM_EXPORT(clock_gettime),
+    ESP_ELFSYM_EXPORT(strftime),
+
+    /* pthread.h */
+
+    ESP_ELFSYM_EXPORT(pthread_create),
+    ESP_ELFSYM_EXPORT(pthread_attr_init),
+    ESP_ELFSYM_EXPORT(pthread_attr_setstacksize),
+    ESP_ELFSYM_EXPORT(pthread_detach),
+    ESP_ELFSYM_EXPORT(pthread_join),
+    ESP_ELFSYM_EXPORT(pthread_exit),
+
+    /* newlib */
+
+    ESP_ELFSYM_EXPORT(__errno),
+    ESP_ELFSYM_EXPORT(__getreent),
+#ifdef __HAVE_LOCALE_INFO__
+    ESP_ELFSYM_EXPORT(__locale_ctype_ptr),
+#else
+    ESP_ELFSYM_EXPORT(_ctype_),
+#endif
+
+    /* math */
+
+    ESP_ELFSYM_EXPORT(__ltdf2),
+    ESP_ELFSYM_EXPORT(__fixunsdfsi),
+    ESP_ELFSYM_EXPORT(__gtdf2),
+    ESP_ELFSYM_EXPORT(__floatunsidf),
+    ESP_ELFSYM_EXPORT(__divdf3),
+
+    /* getopt.h */
+
+    ESP_ELFSYM_EXPORT(getopt_long),
+    ESP_ELFSYM_EXPORT(optind),
+    ESP_ELFSYM_EXPORT(opterr),
+    ESP_ELFSYM_EXPORT(optarg),
+    ESP_ELFSYM_EXPORT(optopt),
+
+    /* setjmp.h */
+
+    ESP_ELFSYM_EXPORT(longjmp),
+    ESP_ELFSYM_EXPORT(setjmp),
+
+    ESP_ELFSYM_END
+};
+
+/** @brief ESP-IDF public functions symbols look-up table */
+
+static const struct esp_elfsym g_esp_espidf_elfsyms[] = {
+
+    /* sys/socket.h */
+
+    ESP_ELFSYM_EXPORT(lwip_bind),
+    ESP_ELFSYM_EXPORT(lwip_setsockopt),
+    ESP_ELFSYM_EXPORT(lwip_socket),
+    ESP_ELFSYM_EXPORT(lwip_listen),
+    ESP_ELFSYM_EXPORT(lwip_accept),
+    ESP_ELFSYM_EXPORT(lwip_recv),
+    ESP_ELFSYM_EXPORT(lwip_recvfrom),
+    ESP_ELFSYM_EXPORT(lwip_send),
+    ESP_ELFSYM_EXPORT(lwip_sendto),
+    ESP_ELFSYM_EXPORT(lwip_connect),
+
+    /* arpa/inet.h */
+
+    ESP_ELFSYM_EXPORT(ipaddr_addr),
+    ESP_ELFSYM_EXPORT(lwip_htons),
+    ESP_ELFSYM_EXPORT(lwip_htonl),
+    ESP_ELFSYM_EXPORT(ip4addr_ntoa),
+
+    /* ROM functions */
+
+    ESP_ELFSYM_EXPORT(ets_printf),
+
+    ESP_ELFSYM_END
+};
+
+/** @brief Ranks of the built-in tables, registered tables always come first */
+
+#define ELF_SYMTAB_RANK_LIBC    (UINT32_MAX - 1)
+#define ELF_SYMTAB_RANK_ESPIDF  UINT32_MAX
+
+/** @brief Namespace of the table set by elf_set_custom_symbols */
+
+#define ELF_SYMTAB_CUSTOM_NS    "custom"
+
+/** @brief A registered symbol table */
+
+struct esp_elfsym_table {
+    const struct esp_elfsym *syms;  /*!< Table terminated by ESP_ELFSYM_END */
+    const char *ns;                 /*!< Namespace given at registration */
+    uint32_t rank;                  /*!< Lookup priority, lower wins */
+};
+
+/** @brief Entry of the merged index */
+
+struct esp_elfsym_rank {
+    const struct esp_elfsym *sym;   /*!< Symbol in one of the tables */
+    uint32_t rank;                  /*!< Rank of its table */
+};
+
+static struct esp_elfsym_table *s_tables;
+static size_t s_table_count;
+static uint32_t s_next_rank = 1;
+
+static struct esp_elfsym_rank *s_sym_index;
+static size_t s_sym_count;
+static bool s_builtin_merged;
+static _lock_t s_sym_lock;
+
+static int elf_sym_rank_cmp(const void *a, const void *b)
+{
+    const struct esp_elfsym_rank *x = a;
+    const struct esp_elfsym_rank *y = b;
+    int ret = strcmp(x->sym->name, y->sym->name);
+
+    if (!ret) {
+        ret = x->rank < y->rank ? -1 : x->rank > y->rank;
+    }
+
+    return ret;
+}
+
+static const char *elf_sym_rank_ns(uint32_t rank)
+{
+    if (rank == ELF_SYMTAB_RANK_LIBC) {
+        return "libc";
+    } else if (rank == ELF_SYMTAB_RANK_ESPIDF) {
+        return "esp-idf";
+    }
+
+    for (size_t i = 0; i < s_table_count; i++) {
+        if (s_tables[i].rank == rank) {
+            return s_tables[i].ns;
+        }
+    }
+
+    return "?";
+}
+
+/**
+ * @brief Merge a symbol table into the sorted index.
+ *
+ * Entries of all tables stay in the index, sorted by name and then by rank,
+ * so that removing a table uncovers the entries it shadowed without a
+ * rebuild. Only the new table is sorted, the index is merged in one pass.
+ * Must be called with s_sym_lock held.
+ *
+ * @param syms - Symbol table
+ * @param rank - Rank of the table
+ * @param ns   - Namespace of the table, for messages
+ *
+ * @return 0 if success or -ENOMEM.
+ */
+static int elf_sym_index_merge(const struct esp_elfsym *syms, uint32_t rank, const char *ns)
+{
+    size_t m = 0;
+    size_t i = 0;
+    size_t j = 0;
+    size_t n = 0;
+    struct esp_elfsym_rank *add;
+    struct esp_elfsym_rank *merged;
+
+    while (syms[m].name) {
+        m++;
+    }
+
+    if (!m) {
+        return 0;
+    }
+
+    add = malloc(m * sizeof(struct esp_elfsym_rank));
+    merged = malloc((s_sym_count + m) * sizeof(struct esp_elfsym_rank));
+    if (!add || !merged) {
+        free(add);
+        free(merged);
+        return -ENOMEM;
+    }
+
+    for (size_t k = 0; k < m; k++) {
+        add[k].sym = &syms[k];
+        add[k].rank = rank;
+    }
+
+    qsort(add, m, sizeof(struct esp_elfsym_rank), elf_sym_rank_cmp);
+
+    while (i < s_sym_count || j < m) {
+        if (j == m || (i < s_sym_count && elf_sym_rank_cmp(&s_sym_index[i], &add[j]) < 0)) {
+            merged[n++] = s_sym_index[i++];
+            continue;
+        }
+
+        /* Shadowing a built-in symbol is intended (e.g. malloc), two registered tables are not */
+
+        if (n && merged[n - 1].rank < ELF_SYMTAB_RANK_LIBC &&
+                !strcmp(merged[n - 1].sym->name, add[j].sym->name)) {
+            ESP_LOGW(TAG, "%s: %s is already exported by %s", ns, add[j].sym->name,
+                     elf_sym_rank_ns(merged[n - 1].rank));
+        }
+
+        merged[n++] = add[j++];
+    }
+
+    free(add);
+    free(s_sym_index);
+    s_sym_index = merged;
+    s_sym_count = n;
+
+    return 0;
+}
+
+/**
+ * @brief Remove all entries of one table from the index.
+ *
+ * @param rank - Rank of the table
+ *
+ * @return None
+ */
+static void elf_sym_index_remove(uint32_t rank)
+{
+    size_t n = 0;
+
+    for (size_t i = 0; i < s_sym_count; i++) {
+        if (s_sym_index[i].rank != rank) {
+            s_sym_index[n++] = s_sym_index[i];
+        }
+    }
+
+    s_sym_count = n;
+}
+
+/**
+ * @brief Add the libc and ESP-IDF tables on first use, with s_sym_lock held.
+ *
+ * @return None
+ */
+static void elf_sym_builtin_merge(void)
+{
+    int ret = 0;
+
+    if (s_builtin_merged) {
+        return;
+    }
+
+#ifdef CONFIG_ELF_LOADER_LIBC_SYMBOLS
+    ret = elf_sym_index_merge(g_esp_libc_elfsyms, ELF_SYMTAB_RANK_LIBC, "libc");
+#else
+    (void)g_esp_libc_elfsyms;
+#endif
+
+#ifdef CONFIG_ELF_LOADER_ESPIDF_SYMBOLS
+    if (!ret) {
+        ret = elf_sym_index_merge(g_esp_espidf_elfsyms, ELF_SYMTAB_RANK_ESPIDF, "esp-idf");
+    }
+#else
+    (void)g_esp_espidf_elfsyms;
+#endif
+
+    if (ret) {
+        elf_sym_index_remove(ELF_SYMTAB_RANK_LIBC);
+        ESP_LOGE(TAG, "No memory for the symbol index");
+        return;
+    }
+
+    s_builtin_merged = true;
+}
+
+/**
+ * @brief Register a symbol table for ELF relocation.
+ *
+ * Tables are searched in registration order, all of them before the libc
+ * and ESP-IDF tables. The table and the namespace string are referenced,
+ * not copied, and must stay valid until the table is unregistered.
+ *
+ * @param symbols - Table terminated by ESP_ELFSYM_END
+ * @param ns      - Unique name of the exporting subsystem
+ *
+ * @return 0 if success, -EINVAL, -EEXIST if ns is taken or -ENOMEM.
+ */
+int elf_register_symbols(const struct esp_elfsym *symbols, const char *ns)
+{
+    int ret = 0;
+    struct esp_elfsym_table *tables;
+
+    if (!symbols || !ns) {
+        return -EINVAL;
+    }
+
+    _lock_acquire(&s_sym_lock);
+
+    elf_sym_builtin_merge();
+
+    for (size_t i = 0; i < s_table_count; i++) {
+        if (!strcmp(s_tables[i].ns, ns)) {
+            ret = -EEXIST;
+            goto exit;
+        }
+    }
+
+    tables = realloc(s_tables, (s_table_count + 1) * sizeof(struct esp_elfsym_table));
+    if (!tables) {
+        ret = -ENOMEM;
+        goto exit;
+    }
+
+    s_tables = tables;
+
+    ret = elf_sym_index_merge(symbols, s_next_rank, ns);
+    if (ret) {
+        goto exit;
+    }
+
+    s_tables[s_table_count].syms = symbols;
+    s_tables[s_table_count].ns = ns;
+    s_tables[s_table_count].rank = s_next_rank++;
+    s_table_count++;
+
+exit:
+    _lock_release(&s_sym_lock);
+
+    return ret;
+}
+
+/**
+ * @brief Unregister the symbol table of a namespace.
+ *
+ * ELF objects that are already relocated keep the resolved addresses.
+ *
+ * @param ns - Namespace given to elf_register_symbols
+ *
+ * @return 0 if success or -ENOENT.
+ */
+int elf_unregister_symbols(const char *ns)
+{
+    int ret = -ENOENT;
+
+    if (!ns) {
+        return -EINVAL;
+    }
+
+    _lock_acquire(&s_sym_lock);
+
+    for (size_t i = 0; i < s_table_count; i++) {
+        if (!strcmp(s_tables[i].ns, ns)) {
+            elf_sym_index_remove(s_tables[i].rank);
+            memmove(&s_tables[i], &s_tables[i + 1], (s_table_count - i - 1) * sizeof(struct esp_elfsym_table));
+            s_table_count--;
+            ret = 0;
+            break;
+        }
+    }
+
+    _lock_release(&s_sym_lock);
+
+    return ret;
+}
+
+/**
+ * @brief Replace the table of the "custom" namespace.
+ *
+ * Kept for existing callers, see elf_register_symbols.
+ *
+ * @param symbols - Table terminated by ESP_ELFSYM_END, NULL removes it
+ *
+ * @return None
+ */
+void elf_set_custom_symbols(const struct esp_elfsym* symbols) {
+    elf_unregister_symbols(ELF_SYMTAB_CUSTOM_NS);
+    if (symbols) {
+        elf_register_symbols(symbols, ELF_SYMTAB_CUSTOM_NS);
+    }
+}
+
+/**
+ * @brief Find symbol address by name.
+ *
+ * Binary search over the merged index. Of several tables exporting a name
+ * the one registered first wins, registered tables win over libc and
+ * ESP-IDF ones so that the application can interpose functions such as
+ * malloc/free.
+ *
+ * @param sym_name - Symbol name
+ *
+ * @return Symbol address if success or 0 if failed.
+ */
+uintptr_t elf_find_sym(const char *sym_name)
+{
+    uintptr_t addr = 0;
+    size_t lo = 0;
+    size_t hi;
+
+    _lock_acquire(&s_sym_lock);
+
+    elf_sym_builtin_merge();
+
+    /* First entry with this name, that is the one with the lowest rank */
+
+    hi = s_sym_count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+
+        if (strcmp(s_sym_index[mid].sym->name, sym_name) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    if (lo < s_sym_count && !strcmp(s_sym_index[lo].sym->name, sym_name)) {
+        addr = (uintptr_t)s_sym_index[lo].sym->sym;
+    }
+
+    _lock_release(&s_sym_lock);
+
+    return addr;
+}
+
+static int elf_sym_name_cmp(const void *key, const void *elem)
+{
+    return strcmp(key, ((const struct esp_elfsym *)elem)->name);
+}
+
+/**
+ * @brief Find symbol address by name, falling back to the tables of a load scope.
+ *
+ * Scope tables belong to one ELF object, e.g. the exports of the shared
+ * libraries it was linked against. They are never entered into the global
+ * index, so they can neither shadow libc and ESP-IDF nor leak into objects
+ * that do not hold a reference on them.
+ *
+ * @param sym_name - Symbol name
+ * @param scope    - Tables sorted by name, searched in order, may be NULL
+ * @param count    - Number of tables in scope
+ *
+ * @return Symbol address if success or 0 if failed.
+ */
+uintptr_t elf_find_sym_scope(const char *sym_name, const struct esp_elfsym_scope *scope, uint32_t count)
+{
+    uintptr_t addr = elf_find_sym(sym_name);
+
+    for (uint32_t i = 0; !addr && i < count; i++) {
+        const struct esp_elfsym *sym = bsearch(sym_name, scope[i].syms, scope[i].count,
+                                               sizeof(struct esp_elfsym), elf_sym_name_cmp);
+
+        if (sym) {
+            addr = (uintptr_t)sym->sym;
+        }
+    }
+
+    return addr;
+}
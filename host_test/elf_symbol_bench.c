@@ -0,0 +1,167 @@
+// Vergleicht auf dem Host die Symbolsuche des ELF-Loaders: lineare Suche mit strcmp
+// durch die Exporttabellen (wie elf_find_sym früher) gegen den nach Namen sortierten
+// Index mit bsearch (components/elf_loader/src/esp_elf_symbol.c).
+//
+//   cc -std=gnu11 -O2 -Wall host_test/elf_symbol_bench.c -o elf_symbol_bench
+//   ./elf_symbol_bench [Quelldateien...]
+//
+// Die Namen werden aus den Quelldateien gelesen (ESP_ELFSYM_EXPORT(name) und
+// { "name", ... }), ohne Angabe aus den Exporttabellen des Loaders und des OS.
+// Gesucht wird wie beim Relozieren: jeder Name einmal in zufälliger Reihenfolge,
+// dazu ein Anteil unbekannter Namen, die erst in Bibliotheken gefunden werden.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MAX_SYMS     1024
+#define MAX_NAME_LEN 64
+#define ROUNDS       2000  // Durchläufe über alle Namen
+#define MISS_EVERY   8     // Jeder achte gesuchte Name ist unbekannt
+
+static const char *default_sources[] = {
+	"components/elf_loader/src/esp_elf_symbol.c",
+	"main/systemCalls.c",
+};
+
+static char names[MAX_SYMS][MAX_NAME_LEN];
+static const char *table[MAX_SYMS];   // Reihenfolge wie in den Quellen
+static const char *sorted[MAX_SYMS];  // Sortierter Index
+static size_t count;
+
+// Hängt einen Namen an, Duplikate zählen wie in den Tabellen nur einmal
+static void add_name(const char *name, size_t len) {
+	if (len == 0 || len >= MAX_NAME_LEN || count >= MAX_SYMS) {
+		return;
+	}
+	for (size_t i = 0; i < count; i++) {
+		if (strlen(table[i]) == len && strncmp(table[i], name, len) == 0) {
+			return;
+		}
+	}
+	memcpy(names[count], name, len);
+	names[count][len] = '\0';
+	table[count] = names[count];
+	count++;
+}
+
+// Liest die exportierten Namen aus einer Quelldatei
+static int scan_source(const char *path) {
+	FILE *file = fopen(path, "r");
+	if (file == NULL) {
+		perror(path);
+		return -1;
+	}
+	char line[256];
+	while (fgets(line, sizeof(line), file) != NULL) {
+		const char *p = strstr(line, "ESP_ELFSYM_EXPORT(");
+		if (p != NULL) {
+			p += strlen("ESP_ELFSYM_EXPORT(");
+			add_name(p, strcspn(p, ")"));
+			continue;
+		}
+		p = strstr(line, "{ \"");
+		if (p != NULL && strstr(p + 3, "\",") != NULL) {
+			p += 3;
+			add_name(p, strcspn(p, "\""));
+		}
+	}
+	fclose(file);
+	return 0;
+}
+
+static int cmp_name(const void *a, const void *b) {
+	return strcmp(*(const char *const *)a, *(const char *const *)b);
+}
+
+static int cmp_key(const void *key, const void *entry) {
+	return strcmp(key, *(const char *const *)entry);
+}
+
+static const char *find_linear(const char *name) {
+	for (size_t i = 0; i < count; i++) {
+		if (strcmp(table[i], name) == 0) {
+			return table[i];
+		}
+	}
+	return NULL;
+}
+
+static const char *find_sorted(const char *name) {
+	const char **hit = bsearch(name, sorted, count, sizeof(sorted[0]), cmp_key);
+	return hit != NULL ? *hit : NULL;
+}
+
+static double now_ns(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Misst die mittlere Dauer einer Suche in ns. hits dient als Prüfsumme und verhindert,
+// dass der Compiler die Suche wegoptimiert.
+static double bench(const char *(*find)(const char *), const char **keys, size_t n, size_t *hits) {
+	*hits = 0;
+	double start = now_ns();
+	for (int r = 0; r < ROUNDS; r++) {
+		for (size_t i = 0; i < n; i++) {
+			*hits += find(keys[i]) != NULL;
+		}
+	}
+	return (now_ns() - start) / ((double)ROUNDS * n);
+}
+
+int main(int argc, char **argv) {
+	int sources = argc > 1 ? argc - 1 : (int)(sizeof(default_sources) / sizeof(default_sources[0]));
+	for (int i = 0; i < sources; i++) {
+		if (scan_source(argc > 1 ? argv[i + 1] : default_sources[i]) != 0) {
+			return 1;
+		}
+	}
+	if (count == 0) {
+		fprintf(stderr, "Keine exportierten Symbole gefunden\n");
+		return 1;
+	}
+	memcpy(sorted, table, count * sizeof(table[0]));
+	qsort(sorted, count, sizeof(sorted[0]), cmp_name);
+
+	// Suchreihenfolge: alle Namen gemischt, dazu unbekannte Namen
+	static char misses[MAX_SYMS][MAX_NAME_LEN];
+	static const char *keys[2 * MAX_SYMS];
+	size_t n = 0;
+	for (size_t i = 0; i < count; i++) {
+		keys[n++] = table[i];
+		if (i % MISS_EVERY == 0) {
+			snprintf(misses[i], MAX_NAME_LEN, "lib_%s", table[i]);
+			keys[n++] = misses[i];
+		}
+	}
+	srand(1);
+	for (size_t i = n - 1; i > 0; i--) {
+		size_t j = (size_t)rand() % (i + 1);
+		const char *tmp = keys[i];
+		keys[i] = keys[j];
+		keys[j] = tmp;
+	}
+
+	// Beide Verfahren müssen dieselben Symbole finden
+	for (size_t i = 0; i < n; i++) {
+		if (find_linear(keys[i]) != find_sorted(keys[i])) {
+			fprintf(stderr, "FEHLER: %s unterschiedlich aufgelöst\n", keys[i]);
+			return 1;
+		}
+	}
+
+	size_t hits_linear, hits_sorted;
+	double linear = bench(find_linear, keys, n, &hits_linear);
+	double sorted_ns = bench(find_sorted, keys, n, &hits_sorted);
+	if (hits_linear != hits_sorted) {
+		fprintf(stderr, "FEHLER: %zu statt %zu Treffer\n", hits_sorted, hits_linear);
+		return 1;
+	}
+	printf("%zu Symbole, %zu Suchen je Durchlauf (%zu unbekannt)\n", count, n, n - count);
+	printf("linear:          %8.1f ns/Suche\n", linear);
+	printf("sortiert+bsearch:%8.1f ns/Suche (Faktor %.1f)\n", sorted_ns, linear / sorted_ns);
+	return 0;
+}
@@ -0,0 +1,167 @@
+// Stresstest für den SPSC-Ring aus main/include/ipc_ring.h auf dem Host.
+//
+//   cc -std=gnu11 -O2 -Wall -pthread -I main/include host_test/ipc_ring_test.c -o ipc_ring_test
+//   ./ipc_ring_test
+//
+// Mit -fsanitize=thread prüft ThreadSanitizer zusätzlich, dass die Daten im Ring
+// durch die Speicherordnungen von head/tail korrekt veröffentlicht werden.
+// Producer und Consumer laufen als pthreads; xTaskNotifyGive/ulTaskNotifyTake
+// werden durch eine Semaphore ersetzt.
+
+#include <errno.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "ipc_ring.h"
+
+#define RING_SIZE   64         // Klein, damit der Ring ständig überläuft
+#define STREAM_LEN  (8u << 20) // Übertragene Bytes
+#define MAX_CHUNK   37         // Teilt RING_SIZE nicht, Schreib- und Lesestücke wandern
+#define WAKE_TIMEOUT_S 2       // Länger schläft der Consumer nur bei verlorenem Wecken
+
+static IPCRing *ring;
+static sem_t notify;           // Benachrichtigung des Consumers
+static unsigned long wakeups;  // Wie oft der Consumer geschlafen hat
+static int failed;
+
+// Inhalt des Datenstroms an Position pos
+static uint8_t pattern(uint32_t pos) {
+	return (uint8_t)((pos * 2654435761u) >> 24);
+}
+
+// Einfacher Zufallsgenerator je Thread
+static uint32_t next_rand(uint32_t *state) {
+	*state ^= *state << 13;
+	*state ^= *state >> 17;
+	*state ^= *state << 5;
+	return *state;
+}
+
+static void *producer(void *arg) {
+	uint8_t chunk[MAX_CHUNK];
+	uint32_t seed = 0x12345678;
+	uint32_t pos = 0;
+	if (ipc_ring_claim(&ring->producer, arg) != 0) {
+		fprintf(stderr, "Producer konnte die Rolle nicht übernehmen\n");
+		failed = 1;
+		return NULL;
+	}
+	while (pos < STREAM_LEN && !failed) {
+		size_t len = 1 + next_rand(&seed) % MAX_CHUNK;
+		if (len > STREAM_LEN - pos) {
+			len = STREAM_LEN - pos;
+		}
+		for (size_t i = 0; i < len; i++) {
+			chunk[i] = pattern(pos + i);
+		}
+		size_t done = 0;
+		while (done < len && !failed) {
+			int wake;
+			size_t n = ipc_ring_put(ring, chunk + done, len - done, &wake);
+			if (wake) {
+				sem_post(&notify);
+			}
+			if (n == 0) {
+				sched_yield();  // Ring voll, der Producer blockiert nie
+			}
+			done += n;
+		}
+		pos += len;
+	}
+	return NULL;
+}
+
+static void *consumer(void *arg) {
+	uint8_t chunk[MAX_CHUNK];
+	uint32_t seed = 0x9e3779b9;
+	uint32_t pos = 0;
+	if (ipc_ring_claim(&ring->consumer, arg) != 0) {
+		fprintf(stderr, "Consumer konnte die Rolle nicht übernehmen\n");
+		failed = 1;
+		return NULL;
+	}
+	while (pos < STREAM_LEN && !failed) {
+		size_t len = 1 + next_rand(&seed) % MAX_CHUNK;
+		size_t n = ipc_ring_get(ring, chunk, len);
+		if (n == 0) {
+			// Wie ipc_ring_read: Flag setzen, erneut prüfen, dann schlafen
+			while (!ipc_ring_prepare_wait(ring)) {
+				struct timespec deadline;
+				clock_gettime(CLOCK_REALTIME, &deadline);
+				deadline.tv_sec += WAKE_TIMEOUT_S;
+				wakeups++;
+				if (sem_timedwait(&notify, &deadline) != 0 && errno == ETIMEDOUT) {
+					fprintf(stderr, "Consumer nicht geweckt bei Position %u\n", pos);
+					failed = 1;
+					break;
+				}
+			}
+			ipc_ring_end_wait(ring);
+			continue;
+		}
+		for (size_t i = 0; i < n; i++) {
+			if (chunk[i] != pattern(pos + i)) {
+				fprintf(stderr, "Falsches Byte bei Position %u: %02x statt %02x\n",
+					(unsigned)(pos + i), chunk[i], pattern(pos + i));
+				failed = 1;
+				return NULL;
+			}
+		}
+		pos += n;
+	}
+	return NULL;
+}
+
+// Die Rollen werden beim ersten Zugriff vergeben und nur vom Inhaber freigegeben
+static int test_claim(void) {
+	int a, b;
+	void *producer_role = NULL;
+	if (ipc_ring_claim(&producer_role, &a) != 0 || ipc_ring_claim(&producer_role, &a) != 0) {
+		return -1;
+	}
+	if (ipc_ring_claim(&producer_role, &b) == 0) {
+		return -1;  // Zweiter Producer darf nicht zugelassen werden
+	}
+	ipc_ring_unclaim(&producer_role, &b);
+	if (producer_role != &a) {
+		return -1;  // Fremder Task darf die Rolle nicht freigeben
+	}
+	ipc_ring_unclaim(&producer_role, &a);
+	return ipc_ring_claim(&producer_role, &b);
+}
+
+int main(void) {
+	if (test_claim() != 0) {
+		fprintf(stderr, "Rollenvergabe fehlerhaft\n");
+		return 1;
+	}
+
+	ring = calloc(1, sizeof(IPCRing) + RING_SIZE);
+	if (ring == NULL) {
+		return 1;
+	}
+	ring->size = RING_SIZE;
+	sem_init(&notify, 0, 0);
+
+	int producer_task, consumer_task;
+	pthread_t threads[2];
+	pthread_create(&threads[0], NULL, consumer, &consumer_task);
+	pthread_create(&threads[1], NULL, producer, &producer_task);
+	pthread_join(threads[1], NULL);
+	if (failed) {
+		sem_post(&notify);  // Consumer nicht schlafend zurücklassen
+	}
+	pthread_join(threads[0], NULL);
+
+	if (!failed && (ring->head != STREAM_LEN || ring->tail != STREAM_LEN)) {
+		fprintf(stderr, "head %u / tail %u statt %u\n", ring->head, ring->tail, STREAM_LEN);
+		failed = 1;
+	}
+	printf("%s: %u Bytes über %d Byte Ring, Consumer %lu mal geschlafen\n",
+		failed ? "FEHLER" : "OK", STREAM_LEN, RING_SIZE, wakeups);
+	sem_destroy(&notify);
+	free(ring);
+	return failed;
+}
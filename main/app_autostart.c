@@ -0,0 +1,243 @@
+#include "app_autostart.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include "cJSON.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "systemCalls.h"
+
+static const char *TAG = "AUTOSTART";
+
+#define APP_AUTOSTART_MAX      16
+#define APP_AUTOSTART_MAX_DEPS 4
+#define APP_AUTOSTART_MAX_SIZE 2048
+#define APP_AUTOSTART_NAME_LEN 32
+#define APP_AUTOSTART_STACK    4096
+#define APP_AUTOSTART_PRIORITY 3
+// Wartezeit, wenn die Loader-Warteschlange voll ist
+#define APP_AUTOSTART_RETRY_MS 50
+
+typedef enum {
+	AUTOSTART_PENDING,   // Wartet auf Abhängigkeiten
+	AUTOSTART_QUEUED,    // Beim Loader eingereiht
+	AUTOSTART_RUNNING,   // Gestartet
+	AUTOSTART_FAILED,    // Laden fehlgeschlagen
+	AUTOSTART_SKIPPED,   // Abhängigkeit fehlgeschlagen oder zyklisch
+} AutostartState;
+
+typedef struct {
+	char name[APP_AUTOSTART_NAME_LEN];
+	char after[APP_AUTOSTART_MAX_DEPS][APP_AUTOSTART_NAME_LEN];  // Namen aus der Datei
+	int8_t deps[APP_AUTOSTART_MAX_DEPS];  // Aufgelöste Einträge
+	uint8_t dep_count;
+	AutostartState state;
+	AppLoadResult_t res;  // Vom Loader geschrieben, status 0 = noch nicht fertig
+	uint32_t ready_us;    // Seit Beginn des Autostarts bis zum Start der App
+} AutostartEntry;
+
+static int autostart_find(const AutostartEntry *list, int count, const char *name) {
+	for (int i = 0; i < count; i++) {
+		if (strcmp(list[i].name, name) == 0) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+// Liest die Autostart-Liste. Einträge sind Namen oder Objekte mit Abhängigkeiten:
+// { "apps": [ "sensor", { "name": "display", "after": ["sensor"] } ] }
+// Liefert die Anzahl der Einträge oder -1.
+static int autostart_load(AutostartEntry *list) {
+	FILE *file = fopen(APP_AUTOSTART_PATH, "r");
+	if (file == NULL) {
+		return -1;
+	}
+	char *text = malloc(APP_AUTOSTART_MAX_SIZE + 1);
+	if (text == NULL) {
+		fclose(file);
+		return -1;
+	}
+	size_t len = fread(text, 1, APP_AUTOSTART_MAX_SIZE, file);
+	fclose(file);
+	text[len] = '\0';
+
+	cJSON *json = cJSON_Parse(text);
+	free(text);
+	if (json == NULL) {
+		ESP_LOGE(TAG, "%s: JSON-Parsing fehlgeschlagen", APP_AUTOSTART_PATH);
+		return -1;
+	}
+
+	int count = 0;
+	cJSON *apps = cJSON_GetObjectItem(json, "apps");
+	cJSON *item;
+	cJSON_ArrayForEach(item, apps) {
+		cJSON *name = cJSON_IsString(item) ? item : cJSON_GetObjectItem(item, "name");
+		if (!cJSON_IsString(name) || strlen(name->valuestring) >= APP_AUTOSTART_NAME_LEN) {
+			ESP_LOGW(TAG, "Ungültiger Eintrag in apps");
+			continue;
+		}
+		if (count >= APP_AUTOSTART_MAX) {
+			ESP_LOGW(TAG, "Mehr als %d Apps, Rest wird ignoriert", APP_AUTOSTART_MAX);
+			break;
+		}
+		if (autostart_find(list, count, name->valuestring) >= 0) {
+			ESP_LOGW(TAG, "%s ist doppelt eingetragen", name->valuestring);
+			continue;
+		}
+		AutostartEntry *entry = &list[count++];
+		memset(entry, 0, sizeof(AutostartEntry));
+		strcpy(entry->name, name->valuestring);
+		cJSON *dep;
+		cJSON_ArrayForEach(dep, cJSON_GetObjectItem(item, "after")) {
+			if (!cJSON_IsString(dep) || strlen(dep->valuestring) >= APP_AUTOSTART_NAME_LEN) {
+				ESP_LOGW(TAG, "%s: ungültiger Eintrag in after", entry->name);
+			} else if (entry->dep_count >= APP_AUTOSTART_MAX_DEPS) {
+				ESP_LOGW(TAG, "%s: mehr als %d Abhängigkeiten", entry->name, APP_AUTOSTART_MAX_DEPS);
+				break;
+			} else {
+				strcpy(entry->after[entry->dep_count++], dep->valuestring);
+			}
+		}
+	}
+	cJSON_Delete(json);
+
+	// Abhängigkeiten erst auflösen, wenn alle Einträge bekannt sind
+	for (int i = 0; i < count; i++) {
+		AutostartEntry *entry = &list[i];
+		uint8_t n = 0;
+		for (int d = 0; d < entry->dep_count; d++) {
+			int dep = autostart_find(list, count, entry->after[d]);
+			if (dep < 0 || dep == i) {
+				ESP_LOGW(TAG, "%s: Abhängigkeit %s steht nicht in der Liste", entry->name, entry->after[d]);
+				continue;
+			}
+			entry->deps[n++] = dep;
+		}
+		entry->dep_count = n;
+	}
+	return count;
+}
+
+// Liefert RUNNING, wenn alle Abhängigkeiten laufen, SKIPPED, wenn eine nicht mehr
+// starten kann, sonst PENDING
+static AutostartState autostart_deps(const AutostartEntry *list, const AutostartEntry *entry) {
+	AutostartState state = AUTOSTART_RUNNING;
+	for (int d = 0; d < entry->dep_count; d++) {
+		AutostartState dep = list[entry->deps[d]].state;
+		if (dep == AUTOSTART_FAILED || dep == AUTOSTART_SKIPPED) {
+			return AUTOSTART_SKIPPED;
+		}
+		if (dep != AUTOSTART_RUNNING) {
+			state = AUTOSTART_PENDING;
+		}
+	}
+	return state;
+}
+
+// Reicht alle Apps, deren Abhängigkeiten laufen, gleichzeitig an die Loader weiter
+// und gibt die nächsten frei, sobald eine fertig ist
+static void autostart_task(void *arg) {
+	int64_t start = esp_timer_get_time();
+	AutostartEntry *list = calloc(APP_AUTOSTART_MAX, sizeof(AutostartEntry));
+	int count = list ? autostart_load(list) : -1;
+	if (count <= 0) {
+		free(list);
+		vTaskDelete(NULL);
+		return;
+	}
+	ESP_LOGI(TAG, "%d Apps aus %s", count, APP_AUTOSTART_PATH);
+
+	int open = count;
+	int in_flight = 0;
+	while (open > 0) {
+		int progress = 0;
+		int blocked = 0;
+		for (int i = 0; i < count; i++) {
+			AutostartEntry *entry = &list[i];
+			if (entry->state != AUTOSTART_PENDING) {
+				continue;
+			}
+			AutostartState deps = autostart_deps(list, entry);
+			if (deps == AUTOSTART_SKIPPED) {
+				ESP_LOGW(TAG, "%s wird nicht gestartet, eine Abhängigkeit fehlt", entry->name);
+				entry->state = AUTOSTART_SKIPPED;
+				open--;
+				progress = 1;
+			} else if (deps == AUTOSTART_RUNNING) {
+				if (app_load_async(entry->name, xTaskGetCurrentTaskHandle(), &entry->res) != 0) {
+					blocked = 1;
+					continue;
+				}
+				entry->state = AUTOSTART_QUEUED;
+				in_flight++;
+				progress = 1;
+			}
+		}
+		if (in_flight == 0 && !progress && !blocked) {
+			// Übrig sind nur Einträge mit zyklischen Abhängigkeiten
+			break;
+		}
+		if (in_flight > 0 || blocked) {
+			ulTaskNotifyTake(pdTRUE, in_flight > 0 ? portMAX_DELAY : pdMS_TO_TICKS(APP_AUTOSTART_RETRY_MS));
+		}
+		// Der Loader schreibt das Ergebnis vor der Benachrichtigung
+		for (int i = 0; i < count; i++) {
+			AutostartEntry *entry = &list[i];
+			if (entry->state != AUTOSTART_QUEUED || entry->res.status == 0) {
+				continue;
+			}
+			entry->state = entry->res.status == 1 ? AUTOSTART_RUNNING : AUTOSTART_FAILED;
+			entry->ready_us = (uint32_t)(esp_timer_get_time() - start);
+			in_flight--;
+			open--;
+		}
+	}
+
+	int running = 0;
+	uint32_t last_us = 0;
+	for (int i = 0; i < count; i++) {
+		AutostartEntry *entry = &list[i];
+		switch (entry->state) {
+		case AUTOSTART_RUNNING:
+			ESP_LOGI(TAG, "%-16s läuft nach %lu ms (Warteschlange %lu us, Laden %lu us, gesamt %lu us)",
+				entry->name, (unsigned long)(entry->ready_us / 1000), (unsigned long)entry->res.wait_us,
+				(unsigned long)entry->res.load_us, (unsigned long)entry->res.total_us);
+			running++;
+			if (entry->ready_us > last_us) {
+				last_us = entry->ready_us;
+			}
+			break;
+		case AUTOSTART_FAILED:
+			ESP_LOGE(TAG, "%-16s fehlgeschlagen (%d)", entry->name, entry->res.status);
+			break;
+		case AUTOSTART_PENDING:
+			ESP_LOGE(TAG, "%-16s nicht gestartet, zyklische Abhängigkeit", entry->name);
+			break;
+		default:
+			ESP_LOGE(TAG, "%-16s nicht gestartet", entry->name);
+			break;
+		}
+	}
+	ESP_LOGI(TAG, "%d von %d Apps laufen nach %lu ms", running, count, (unsigned long)(last_us / 1000));
+	free(list);
+	vTaskDelete(NULL);
+}
+
+// Startet die Apps aus der Autostart-Liste im Hintergrund. Ohne Liste passiert nichts.
+int app_autostart_init(void) {
+	struct stat st;
+	if (stat(APP_AUTOSTART_PATH, &st) != 0) {
+		return 0;
+	}
+	if (xTaskCreate(autostart_task, "autostart", APP_AUTOSTART_STACK, NULL,
+			APP_AUTOSTART_PRIORITY, NULL) != pdPASS) {
+		ESP_LOGE(TAG, "Autostart-Task konnte nicht erstellt werden");
+		return -1;
+	}
+	return 0;
+}
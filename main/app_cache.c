@@ -0,0 +1,142 @@
+#include "app_cache.h"
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+
+static const char *TAG = "APP CACHE";
+
+// Anzahl der Images, die nach dem Beenden einer App im Speicher bleiben
+#define APP_CACHE_ENTRIES 4
+
+static AppImage_t app_cache[APP_CACHE_ENTRIES];
+static uint32_t app_cache_clock = 0;
+static SemaphoreHandle_t app_cache_lock = NULL;
+
+// Gibt die Sektionen eines Eintrags frei und markiert ihn als leer
+static void app_cache_evict(AppImage_t *image) {
+	ESP_LOGI(TAG, "%s wird aus dem Cache entfernt", image->path);
+	esp_elf_deinit(&image->elf);
+	heap_caps_free(image->data_copy);
+	image->data_copy = NULL;
+	image->path[0] = '\0';
+}
+
+void app_cache_init(void) {
+	app_cache_lock = xSemaphoreCreateMutex();
+}
+
+// Sucht ein passendes Image. Bei einem Treffer werden .data aus der Kopie
+// wiederhergestellt und .bss genullt, danach kann direkt der Einsprungpunkt
+// angesprungen werden. Liefert NULL, wenn nichts Passendes im Cache liegt.
+AppImage_t *app_cache_get(const char *path, time_t mtime, long size) {
+	if (app_cache_lock == NULL) {
+		return NULL;
+	}
+	AppImage_t *found = NULL;
+	xSemaphoreTake(app_cache_lock, portMAX_DELAY);
+	for (int i = 0; i < APP_CACHE_ENTRIES; i++) {
+		AppImage_t *image = &app_cache[i];
+		if (image->path[0] == '\0' || strcmp(image->path, path) != 0) {
+			continue;
+		}
+		if (image->mtime != mtime || image->size != size) {
+			// Datei wurde geändert, altes Image ist wertlos
+			if (!image->in_use) {
+				app_cache_evict(image);
+			}
+			break;
+		}
+		if (!image->in_use) {
+			esp_elf_sec_t *data = &image->elf.sec[ELF_SEC_DATA];
+			esp_elf_sec_t *bss = &image->elf.sec[ELF_SEC_BSS];
+			if (data->size) {
+				memcpy((void *)data->addr, image->data_copy, data->size);
+			}
+			if (bss->size) {
+				memset((void *)bss->addr, 0, bss->size);
+			}
+			image->in_use = 1;
+			image->last_used = ++app_cache_clock;
+			found = image;
+		}
+		break;
+	}
+	xSemaphoreGive(app_cache_lock);
+	return found;
+}
+
+// Übernimmt ein frisch reloziertes Image in den Cache. Ist kein Platz frei, wird das
+// am längsten unbenutzte Image verdrängt. Liefert NULL, wenn nichts übernommen wurde,
+// die Sektionen gehören dann weiterhin dem Aufrufer.
+AppImage_t *app_cache_put(const char *path, time_t mtime, long size, const esp_elf_t *elf) {
+	if (app_cache_lock == NULL || strlen(path) >= sizeof(app_cache[0].path)) {
+		return NULL;
+	}
+	uint8_t *data_copy = NULL;
+	const esp_elf_sec_t *data = &elf->sec[ELF_SEC_DATA];
+	if (data->size) {
+		data_copy = heap_caps_malloc(data->size, MALLOC_CAP_SPIRAM);
+		if (data_copy == NULL) {
+			return NULL;
+		}
+		memcpy(data_copy, (const void *)data->addr, data->size);
+	}
+
+	xSemaphoreTake(app_cache_lock, portMAX_DELAY);
+	AppImage_t *slot = NULL;
+	for (int i = 0; i < APP_CACHE_ENTRIES; i++) {
+		AppImage_t *image = &app_cache[i];
+		if (image->path[0] == '\0') {
+			slot = image;
+			break;
+		}
+		if (!image->in_use && (slot == NULL || image->last_used < slot->last_used)) {
+			slot = image;
+		}
+	}
+	if (slot != NULL) {
+		if (slot->path[0] != '\0') {
+			app_cache_evict(slot);
+		}
+		strcpy(slot->path, path);
+		slot->mtime = mtime;
+		slot->size = size;
+		slot->elf = *elf;
+		slot->data_copy = data_copy;
+		slot->in_use = 1;
+		slot->last_used = ++app_cache_clock;
+	}
+	xSemaphoreGive(app_cache_lock);
+
+	if (slot == NULL) {
+		heap_caps_free(data_copy);
+	}
+	return slot;
+}
+
+// Gibt ein Image nach dem Beenden der App für den nächsten Start frei
+void app_cache_release(AppImage_t *image) {
+	xSemaphoreTake(app_cache_lock, portMAX_DELAY);
+	image->in_use = 0;
+	xSemaphoreGive(app_cache_lock);
+}
+
+// Verwirft alle unbenutzten Images, z. B. wenn beim Laden der Speicher knapp wird.
+// Liefert die Anzahl freigegebener Images.
+int app_cache_trim(void) {
+	if (app_cache_lock == NULL) {
+		return 0;
+	}
+	int freed = 0;
+	xSemaphoreTake(app_cache_lock, portMAX_DELAY);
+	for (int i = 0; i < APP_CACHE_ENTRIES; i++) {
+		if (app_cache[i].path[0] != '\0' && !app_cache[i].in_use) {
+			app_cache_evict(&app_cache[i]);
+			freed++;
+		}
+	}
+	xSemaphoreGive(app_cache_lock);
+	return freed;
+}
@@ -0,0 +1,158 @@
+#include "app_lib.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/errno.h>
+#include "esp_elf.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "private/elf_symbol.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+static const char *TAG = "APP LIB";
+
+// Maximale Anzahl gleichzeitig geladener Bibliotheken
+#define APP_LIB_MAX 8
+
+// Eine geladene Bibliothek, die sich alle Apps teilen, die sie im Manifest nennen
+typedef struct {
+	char name[APP_LIB_NAME_LEN];  // Name ohne Pfad und Endung
+	esp_elf_t elf;                // Relozierte Sektionen
+	struct esp_elfsym *syms;      // Exportierte Symbole (aus .dynsym), nach Namen sortiert
+	int sym_count;                // Anzahl der exportierten Symbole
+	uint16_t refcnt;              // Anzahl der Apps, die sie verwenden (0 = Eintrag frei)
+	uint32_t size;                // Größe der geladenen Sektionen
+	uint32_t load_us;             // Ladezeit
+} AppLib_t;
+
+static AppLib_t app_libs[APP_LIB_MAX];
+static SemaphoreHandle_t app_lib_lock = NULL;
+
+// Die exportierten Symbole einer Bibliothek sind nicht global registriert. Nur Apps,
+// die sie im Manifest nennen und damit eine Referenz halten, werden gegen sie gelinkt.
+int app_lib_init(void) {
+	app_lib_lock = xSemaphoreCreateMutex();
+	if (app_lib_lock == NULL) {
+		return -1;
+	}
+	memset(app_libs, 0, sizeof(app_libs));
+	return 0;
+}
+
+// Lädt eine Bibliothek beim ersten Benutzer und erhöht sonst nur den Referenzzähler.
+// Liefert das Handle für app_lib_release oder einen negativen Fehlercode.
+int app_lib_acquire(const char *name) {
+	if (app_lib_lock == NULL || name == NULL || strlen(name) >= APP_LIB_NAME_LEN) {
+		return -EINVAL;
+	}
+	xSemaphoreTake(app_lib_lock, portMAX_DELAY);
+	int free_idx = -1;
+	for (int i = 0; i < APP_LIB_MAX; i++) {
+		if (app_libs[i].refcnt == 0) {
+			if (free_idx < 0) {
+				free_idx = i;
+			}
+		} else if (strcmp(app_libs[i].name, name) == 0) {
+			app_libs[i].refcnt++;
+			xSemaphoreGive(app_lib_lock);
+			return i;
+		}
+	}
+	if (free_idx < 0) {
+		xSemaphoreGive(app_lib_lock);
+		ESP_LOGE(TAG, "Keine freien Bibliotheksplätze für %s", name);
+		return -ENOSPC;
+	}
+
+	char path[64];
+	snprintf(path, sizeof(path), "%s%s%s", APP_LIB_PATH, name, APP_LIB_EXT);
+	FILE *file = fopen(path, "rb");
+	if (file == NULL) {
+		xSemaphoreGive(app_lib_lock);
+		ESP_LOGE(TAG, "Bibliothek %s nicht gefunden", path);
+		return -ENOENT;
+	}
+
+	AppLib_t *lib = &app_libs[free_idx];
+	int64_t start = esp_timer_get_time();
+	esp_elf_init(&lib->elf);
+	int ret = esp_elf_relocate_file(&lib->elf, file, NULL);
+	if (ret == 0) {
+		ret = esp_elf_export_symbols(&lib->elf, file, &lib->syms);
+		if (ret < 0) {
+			esp_elf_deinit(&lib->elf);
+		}
+	}
+	fclose(file);
+	if (ret < 0) {
+		memset(lib, 0, sizeof(AppLib_t));
+		xSemaphoreGive(app_lib_lock);
+		ESP_LOGE(TAG, "Bibliothek %s konnte nicht geladen werden (%d)", name, ret);
+		return ret;
+	}
+
+	lib->sym_count = ret;
+	lib->size = 0;
+	for (int i = 0; i < ELF_SECS; i++) {
+		lib->size += lib->elf.sec[i].size;
+	}
+	lib->load_us = (uint32_t)(esp_timer_get_time() - start);
+	strcpy(lib->name, name);
+	lib->refcnt = 1;
+	xSemaphoreGive(app_lib_lock);
+
+	ESP_LOGI(TAG, "Bibliothek %s geladen: %d Symbole, %lu Bytes, %lu us", name, lib->sym_count,
+		(unsigned long)lib->size, (unsigned long)lib->load_us);
+	return free_idx;
+}
+
+// Gibt eine Referenz ab und entlädt die Bibliothek nach dem letzten Benutzer
+void app_lib_release(int lib) {
+	if (lib < 0 || lib >= APP_LIB_MAX || app_lib_lock == NULL) {
+		return;
+	}
+	xSemaphoreTake(app_lib_lock, portMAX_DELAY);
+	AppLib_t *entry = &app_libs[lib];
+	if (entry->refcnt > 0 && --entry->refcnt == 0) {
+		ESP_LOGI(TAG, "Bibliothek %s entladen", entry->name);
+		esp_elf_deinit(&entry->elf);
+		free(entry->syms);
+		memset(entry, 0, sizeof(AppLib_t));
+	}
+	xSemaphoreGive(app_lib_lock);
+}
+
+// Liefert die Symboltabelle einer Bibliothek, gegen die eine App gelinkt werden soll.
+// Der Aufrufer muss eine Referenz aus app_lib_acquire halten.
+int app_lib_scope(int lib, struct esp_elfsym_scope *scope) {
+	if (lib < 0 || lib >= APP_LIB_MAX || app_libs[lib].refcnt == 0) {
+		return -EINVAL;
+	}
+	scope->syms = app_libs[lib].syms;
+	scope->count = app_libs[lib].sym_count;
+	return 0;
+}
+
+// Gibt die geladenen Bibliotheken aus
+void app_lib_print(void) {
+	if (app_lib_lock == NULL) {
+		return;
+	}
+	xSemaphoreTake(app_lib_lock, portMAX_DELAY);
+	int shown = 0;
+	for (int i = 0; i < APP_LIB_MAX; i++) {
+		AppLib_t *lib = &app_libs[i];
+		if (lib->refcnt == 0) {
+			continue;
+		}
+		if (!shown) {
+			printf("Bibliotheken:\n");
+			printf("%-16s %5s %7s %8s %8s\n", "Name", "Refs", "Symbole", "Bytes", "Laden us");
+			shown = 1;
+		}
+		printf("%-16s %5d %7d %8lu %8lu\n", lib->name, lib->refcnt, lib->sym_count,
+			(unsigned long)lib->size, (unsigned long)lib->load_us);
+	}
+	xSemaphoreGive(app_lib_lock);
+}
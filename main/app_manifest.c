@@ -0,0 +1,154 @@
+#include "app_manifest.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cJSON.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+static const char *TAG = "APP MANIFEST";
+
+// Voreinstellungen für Apps ohne Manifest
+#define APP_DEFAULT_STACK     4096
+#define APP_DEFAULT_PRIORITY  5
+#define APP_DEFAULT_CORE      tskNO_AFFINITY
+#define APP_DEFAULT_HEAP_CAPS MALLOC_CAP_SPIRAM
+#define APP_DEFAULT_HEAP_QUOTA 0  // Unbegrenzt, eine Quote setzt nur das Manifest
+#define APP_DEFAULT_STOP_GRACE 2000
+
+// Grenzen für Werte aus dem Manifest
+#define APP_MIN_STACK         2048
+#define APP_MAX_STACK         32768
+#define APP_MAX_PRIORITY      (configMAX_PRIORITIES - 1)
+#define APP_MAX_STOP_GRACE    60000
+#define APP_MANIFEST_MAX_SIZE 1024
+
+void app_manifest_default(AppManifest_t *manifest) {
+	manifest->stack = APP_DEFAULT_STACK;
+	manifest->priority = APP_DEFAULT_PRIORITY;
+	manifest->core = APP_DEFAULT_CORE;
+	manifest->heap_caps = APP_DEFAULT_HEAP_CAPS;
+	manifest->heap_quota = APP_DEFAULT_HEAP_QUOTA;
+	manifest->stop_grace = APP_DEFAULT_STOP_GRACE;
+	manifest->lib_count = 0;
+	manifest->from_file = 0;
+}
+
+// Bildet den Pfad des Manifests aus dem Pfad der ELF-Datei
+static void app_manifest_path(const char *elf_path, char *path, size_t len) {
+	snprintf(path, len, "%s", elf_path);
+	char *ext = strrchr(path, '.');
+	if (ext != NULL) {
+		*ext = '\0';
+	}
+	strncat(path, APP_MANIFEST_EXT, len - strlen(path) - 1);
+}
+
+// Wandelt "spiram", "internal" oder "dma" in MALLOC_CAP_* um
+static int app_manifest_caps(const char *name, uint32_t *caps) {
+	if (strcmp(name, "spiram") == 0) {
+		*caps = MALLOC_CAP_SPIRAM;
+	} else if (strcmp(name, "internal") == 0) {
+		*caps = MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT;
+	} else if (strcmp(name, "dma") == 0) {
+		*caps = MALLOC_CAP_DMA | MALLOC_CAP_8BIT;
+	} else {
+		return -1;
+	}
+	return 0;
+}
+
+// Liest das Manifest einer App. Fehlt es, bleiben die Voreinstellungen stehen.
+// Ungültige Einträge werden gemeldet und ignoriert.
+// Rückgabe: 1 = Manifest gelesen, 0 = kein Manifest, -1 = Manifest fehlerhaft
+int app_manifest_load(const char *elf_path, AppManifest_t *manifest) {
+	char path[128];
+	app_manifest_default(manifest);
+	app_manifest_path(elf_path, path, sizeof(path));
+
+	FILE *file = fopen(path, "r");
+	if (file == NULL) {
+		return 0;
+	}
+	char *text = malloc(APP_MANIFEST_MAX_SIZE + 1);
+	if (text == NULL) {
+		fclose(file);
+		return -1;
+	}
+	size_t len = fread(text, 1, APP_MANIFEST_MAX_SIZE, file);
+	fclose(file);
+	text[len] = '\0';
+
+	cJSON *json = cJSON_Parse(text);
+	free(text);
+	if (json == NULL) {
+		ESP_LOGE(TAG, "%s: JSON-Parsing fehlgeschlagen", path);
+		return -1;
+	}
+
+	cJSON *item = cJSON_GetObjectItem(json, "stack");
+	if (cJSON_IsNumber(item)) {
+		if (item->valueint >= APP_MIN_STACK && item->valueint <= APP_MAX_STACK) {
+			manifest->stack = item->valueint;
+		} else {
+			ESP_LOGW(TAG, "%s: stack %d außerhalb %d..%d", path, item->valueint, APP_MIN_STACK, APP_MAX_STACK);
+		}
+	}
+	item = cJSON_GetObjectItem(json, "priority");
+	if (cJSON_IsNumber(item)) {
+		if (item->valueint >= 1 && item->valueint <= APP_MAX_PRIORITY) {
+			manifest->priority = item->valueint;
+		} else {
+			ESP_LOGW(TAG, "%s: priority %d außerhalb 1..%d", path, item->valueint, APP_MAX_PRIORITY);
+		}
+	}
+	item = cJSON_GetObjectItem(json, "core");
+	if (cJSON_IsNumber(item)) {
+		if (item->valueint >= 0 && item->valueint < portNUM_PROCESSORS) {
+			manifest->core = item->valueint;
+		} else {
+			ESP_LOGW(TAG, "%s: core %d ungültig", path, item->valueint);
+		}
+	}
+	item = cJSON_GetObjectItem(json, "heap");
+	if (cJSON_IsString(item) && app_manifest_caps(item->valuestring, &manifest->heap_caps) != 0) {
+		ESP_LOGW(TAG, "%s: heap \"%s\" unbekannt", path, item->valuestring);
+	}
+	item = cJSON_GetObjectItem(json, "heap_quota");
+	if (cJSON_IsNumber(item)) {
+		if (item->valuedouble >= 0) {
+			manifest->heap_quota = (uint32_t)item->valuedouble;
+		} else {
+			ESP_LOGW(TAG, "%s: heap_quota %d ungültig", path, item->valueint);
+		}
+	}
+	item = cJSON_GetObjectItem(json, "stop_grace");
+	if (cJSON_IsNumber(item)) {
+		if (item->valueint >= 0 && item->valueint <= APP_MAX_STOP_GRACE) {
+			manifest->stop_grace = item->valueint;
+		} else {
+			ESP_LOGW(TAG, "%s: stop_grace %d außerhalb 0..%d", path, item->valueint, APP_MAX_STOP_GRACE);
+		}
+	}
+
+	item = cJSON_GetObjectItem(json, "libs");
+	if (cJSON_IsArray(item)) {
+		cJSON *lib;
+		cJSON_ArrayForEach(lib, item) {
+			if (!cJSON_IsString(lib) || strlen(lib->valuestring) >= APP_LIB_NAME_LEN) {
+				ESP_LOGW(TAG, "%s: ungültiger Eintrag in libs", path);
+			} else if (manifest->lib_count >= APP_MANIFEST_MAX_LIBS) {
+				ESP_LOGW(TAG, "%s: mehr als %d Bibliotheken", path, APP_MANIFEST_MAX_LIBS);
+				break;
+			} else {
+				strcpy(manifest->libs[manifest->lib_count++], lib->valuestring);
+			}
+		}
+	}
+
+	cJSON_Delete(json);
+	manifest->from_file = 1;
+	return 1;
+}
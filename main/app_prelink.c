@@ -0,0 +1,121 @@
+#include "app_prelink.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "esp_app_desc.h"
+#include "esp_log.h"
+
+static const char *TAG = "APP PRELINK";
+
+#define APP_PRELINK_MAGIC 0x4B4E4C50  // "PLNK"
+#define APP_PRELINK_VERSION 1
+
+// Kopf der Prelink-Datei, danach folgen count Einträge vom Typ esp_elf_fixup_t
+typedef struct {
+	uint32_t magic;
+	uint32_t version;
+	uint8_t build_id[32];   // SHA-256 der Firmware, deren Symboladressen eingetragen sind
+	int64_t mtime;          // Änderungszeit der ELF-Datei
+	uint32_t size;          // Größe der ELF-Datei
+	uint32_t count;         // Anzahl der Relokationen
+} AppPrelinkHeader;
+
+// Bildet den Pfad der Prelink-Datei aus dem Pfad der ELF-Datei
+static void app_prelink_path(const char *elf_path, char *path, size_t len) {
+	snprintf(path, len, "%s", elf_path);
+	char *ext = strrchr(path, '.');
+	if (ext != NULL) {
+		*ext = '\0';
+	}
+	strncat(path, APP_PRELINK_EXT, len - strlen(path) - 1);
+}
+
+// Füllt einen Dateikopf für die laufende Firmware und die angegebene ELF-Datei
+static void app_prelink_header(AppPrelinkHeader *hdr, time_t mtime, long size, uint32_t count) {
+	memset(hdr, 0, sizeof(AppPrelinkHeader));
+	hdr->magic = APP_PRELINK_MAGIC;
+	hdr->version = APP_PRELINK_VERSION;
+	memcpy(hdr->build_id, esp_app_get_description()->app_elf_sha256, sizeof(hdr->build_id));
+	hdr->mtime = mtime;
+	hdr->size = size;
+	hdr->count = count;
+}
+
+// Lädt die Prelink-Datei zu einer ELF-Datei. Sie gilt nur, wenn sie zur laufenden
+// Firmware und zum aktuellen Stand der ELF-Datei passt. Liefert 0 bei Erfolg.
+int app_prelink_load(const char *elf_path, time_t mtime, long size, esp_elf_prelink_t *prelink) {
+	char path[128];
+	app_prelink_path(elf_path, path, sizeof(path));
+	memset(prelink, 0, sizeof(esp_elf_prelink_t));
+
+	FILE *file = fopen(path, "rb");
+	if (!file) {
+		return -1;
+	}
+	AppPrelinkHeader hdr, expected;
+	if (fread(&hdr, sizeof(hdr), 1, file) != 1) {
+		fclose(file);
+		return -1;
+	}
+	app_prelink_header(&expected, mtime, size, hdr.count);
+	if (memcmp(&hdr, &expected, sizeof(hdr)) != 0 || hdr.count == 0) {
+		ESP_LOGI(TAG, "%s ist veraltet", path);
+		fclose(file);
+		return -1;
+	}
+	prelink->fixups = malloc(hdr.count * sizeof(esp_elf_fixup_t));
+	if (prelink->fixups == NULL ||
+			fread(prelink->fixups, sizeof(esp_elf_fixup_t), hdr.count, file) != hdr.count) {
+		free(prelink->fixups);
+		prelink->fixups = NULL;
+		fclose(file);
+		return -1;
+	}
+	fclose(file);
+	prelink->count = hdr.count;
+	prelink->capacity = hdr.count;
+	return 0;
+}
+
+// Bereitet eine Tabelle vor, in die der Loader beim Relozieren die Adressen einträgt
+void app_prelink_record(esp_elf_prelink_t *prelink) {
+	memset(prelink, 0, sizeof(esp_elf_prelink_t));
+	prelink->record = true;
+}
+
+// Schreibt die aufgezeichnete Tabelle als Prelink-Datei. Liefert 0 bei Erfolg.
+int app_prelink_save(const char *elf_path, time_t mtime, long size, const esp_elf_prelink_t *prelink) {
+	if (prelink->count == 0) {
+		return -1;
+	}
+	char path[128];
+	app_prelink_path(elf_path, path, sizeof(path));
+	FILE *file = fopen(path, "wb");
+	if (!file) {
+		return -1;
+	}
+	AppPrelinkHeader hdr;
+	app_prelink_header(&hdr, mtime, size, prelink->count);
+	int ok = fwrite(&hdr, sizeof(hdr), 1, file) == 1 &&
+		fwrite(prelink->fixups, sizeof(esp_elf_fixup_t), prelink->count, file) == prelink->count;
+	fclose(file);
+	if (!ok) {
+		unlink(path);
+		return -1;
+	}
+	ESP_LOGI(TAG, "%s mit %lu Relokationen geschrieben", path, (unsigned long)prelink->count);
+	return 0;
+}
+
+// Löscht eine Prelink-Datei, die nicht zur ELF-Datei passt
+void app_prelink_discard(const char *elf_path) {
+	char path[128];
+	app_prelink_path(elf_path, path, sizeof(path));
+	unlink(path);
+}
+
+void app_prelink_free(esp_elf_prelink_t *prelink) {
+	free(prelink->fixups);
+	memset(prelink, 0, sizeof(esp_elf_prelink_t));
+}
@@ -0,0 +1,281 @@
+#include "app_xip.h"
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_attr.h"
+#include "esp_app_desc.h"
+#include "esp_partition.h"
+#include "esp_log.h"
+
+static const char *TAG = "APP XIP";
+
+#define APP_XIP_MAGIC 0x50495841  // "AXIP"
+#define APP_XIP_VERSION 1
+// Jede installierte App belegt einen festen Bereich der Partition: ein Sektor
+// Kopf, danach .text und das Abbild von .data/.rodata/.bss
+#define APP_XIP_SLOT_SIZE (64 * 1024)
+#define APP_XIP_HEADER_SIZE 0x1000
+#define APP_XIP_MAX_SLOTS 16
+// RAM je Slot für .data, .rodata und .bss
+#define APP_XIP_DATA_SIZE (16 * 1024)
+#define APP_XIP_NAME_LEN 32
+
+// Kopf eines Slots, wird nach Code und Daten als Letztes geschrieben
+typedef struct {
+	uint32_t magic;
+	uint32_t version;
+	char name[APP_XIP_NAME_LEN];
+	uint8_t build_id[32];   // SHA-256 der Firmware, gegen die reloziert wurde
+	int64_t mtime;          // Änderungszeit der ELF-Datei
+	uint32_t size;          // Größe der ELF-Datei
+	uint32_t text_run;      // Adresse, an der .text im Flash ausgeführt wird
+	uint32_t text_size;
+	uint32_t data_addr;     // Adresse des Datenbereichs im RAM
+	uint32_t data_size;     // Größe des Abbilds von .data/.rodata/.bss
+	uint32_t entry;         // Einsprungpunkt
+} AppXipHeader;
+
+static const esp_partition_t *app_xip_part = NULL;
+static const uint8_t *app_xip_base = NULL;
+static esp_partition_mmap_handle_t app_xip_map;
+static int app_xip_slots = 0;
+static AppXipHeader app_xip_hdr[APP_XIP_MAX_SLOTS];
+static uint8_t app_xip_in_use[APP_XIP_MAX_SLOTS];
+static SemaphoreHandle_t app_xip_lock = NULL;
+
+// Feste Adressen für die Daten, damit die Relokation über Neustarts hinweg gilt
+#if CONFIG_SPIRAM_ALLOW_BSS_SEG_EXTERNAL_MEMORY
+EXT_RAM_BSS_ATTR
+#endif
+static uint8_t app_xip_arena[APP_XIP_MAX_SLOTS][APP_XIP_DATA_SIZE] __attribute__((aligned(16)));
+
+static uint32_t app_xip_text_addr(int slot) {
+	return (uint32_t)(uintptr_t)(app_xip_base + slot * APP_XIP_SLOT_SIZE + APP_XIP_HEADER_SIZE);
+}
+
+static size_t app_xip_data_offset(const AppXipHeader *hdr) {
+	return APP_XIP_HEADER_SIZE + ((hdr->text_size + 3) & ~3);
+}
+
+// Prüft, ob ein Slot zur laufenden Firmware, zur aktuellen Abbildung der Partition
+// und zum Stand der ELF-Datei passt
+static int app_xip_valid(int slot, time_t mtime, long size) {
+	const AppXipHeader *hdr = &app_xip_hdr[slot];
+	if (hdr->magic != APP_XIP_MAGIC || hdr->version != APP_XIP_VERSION) {
+		return 0;
+	}
+	if (memcmp(hdr->build_id, esp_app_get_description()->app_elf_sha256, sizeof(hdr->build_id)) != 0) {
+		return 0;
+	}
+	if (hdr->text_run != app_xip_text_addr(slot) || hdr->data_addr != (uint32_t)(uintptr_t)app_xip_arena[slot]) {
+		return 0;
+	}
+	return hdr->mtime == mtime && hdr->size == (uint32_t)size;
+}
+
+static int app_xip_find(const char *name) {
+	for (int i = 0; i < app_xip_slots; i++) {
+		if (app_xip_hdr[i].magic == APP_XIP_MAGIC && strcmp(app_xip_hdr[i].name, name) == 0) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+// Bildet die Partition in den Befehlsbus ab und liest die Köpfe aller Slots.
+// Der Befehlsbus erlaubt nur ausgerichtete 32-Bit-Zugriffe, die Köpfe werden daher
+// über esp_partition_read gelesen und im RAM gehalten.
+int app_xip_init(void) {
+	app_xip_part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, APP_XIP_SUBTYPE, APP_XIP_PARTITION);
+	if (app_xip_part == NULL) {
+		ESP_LOGW(TAG, "Keine Partition \"%s\", Apps laufen nur aus dem RAM", APP_XIP_PARTITION);
+		return -1;
+	}
+	const void *ptr;
+	if (esp_partition_mmap(app_xip_part, 0, app_xip_part->size, ESP_PARTITION_MMAP_INST, &ptr, &app_xip_map) != ESP_OK) {
+		ESP_LOGE(TAG, "Partition \"%s\" konnte nicht abgebildet werden", APP_XIP_PARTITION);
+		app_xip_part = NULL;
+		return -1;
+	}
+	app_xip_base = ptr;
+	app_xip_slots = app_xip_part->size / APP_XIP_SLOT_SIZE;
+	if (app_xip_slots > APP_XIP_MAX_SLOTS) {
+		app_xip_slots = APP_XIP_MAX_SLOTS;
+	}
+	for (int i = 0; i < app_xip_slots; i++) {
+		if (esp_partition_read(app_xip_part, i * APP_XIP_SLOT_SIZE, &app_xip_hdr[i], sizeof(AppXipHeader)) != ESP_OK
+				|| app_xip_hdr[i].magic != APP_XIP_MAGIC) {
+			memset(&app_xip_hdr[i], 0, sizeof(AppXipHeader));
+		}
+	}
+	app_xip_lock = xSemaphoreCreateMutex();
+	ESP_LOGI(TAG, "%d Slots ab %p", app_xip_slots, app_xip_base);
+	return 0;
+}
+
+// Reloziert eine App gegen ihren Slot und schreibt Code und Datenabbild in den Flash.
+// Liefert den Slot oder -1 (keine Partition), -2 (App läuft), -3 (kein Slot frei),
+// -4 (Relokation fehlgeschlagen), -5 (zu groß) oder -6 (Schreibfehler).
+int app_xip_install(const char *name, const char *path, time_t mtime, long size) {
+	if (app_xip_lock == NULL || strlen(name) >= APP_XIP_NAME_LEN) {
+		return -1;
+	}
+	xSemaphoreTake(app_xip_lock, portMAX_DELAY);
+	int slot = app_xip_find(name);
+	if (slot < 0) {
+		for (int i = 0; i < app_xip_slots; i++) {
+			if (app_xip_hdr[i].magic != APP_XIP_MAGIC) {
+				slot = i;
+				break;
+			}
+		}
+	}
+	if (slot < 0 || app_xip_in_use[slot]) {
+		xSemaphoreGive(app_xip_lock);
+		return slot < 0 ? -3 : -2;
+	}
+
+	// .text wird nur im RAM zusammengesetzt, die Adressen zeigen bereits in den Flash
+	esp_elf_t elf;
+	esp_elf_init(&elf);
+	elf.text_run = app_xip_text_addr(slot);
+	elf.data_buf = app_xip_arena[slot];
+	elf.data_buf_size = APP_XIP_DATA_SIZE;
+	FILE *file = fopen(path, "rb");
+	int ret = file ? esp_elf_relocate_file(&elf, file, NULL) : -1;
+	if (file) {
+		fclose(file);
+	}
+	if (ret != 0) {
+		ESP_LOGE(TAG, "Relokation von %s fehlgeschlagen (%d)", path, ret);
+		esp_elf_deinit(&elf);
+		xSemaphoreGive(app_xip_lock);
+		return -4;
+	}
+
+	AppXipHeader hdr;
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.magic = APP_XIP_MAGIC;
+	hdr.version = APP_XIP_VERSION;
+	strcpy(hdr.name, name);
+	memcpy(hdr.build_id, esp_app_get_description()->app_elf_sha256, sizeof(hdr.build_id));
+	hdr.mtime = mtime;
+	hdr.size = size;
+	hdr.text_run = elf.text_run;
+	hdr.text_size = elf.sec[ELF_SEC_TEXT].size;
+	hdr.data_addr = (uint32_t)(uintptr_t)elf.data_buf;
+	hdr.data_size = elf.sec[ELF_SEC_DATA].size + elf.sec[ELF_SEC_RODATA].size +
+		elf.sec[ELF_SEC_BSS].size + elf.sec[ELF_SEC_DRLRO].size;
+	hdr.entry = (uint32_t)(uintptr_t)elf.entry;
+	if (app_xip_data_offset(&hdr) + hdr.data_size > APP_XIP_SLOT_SIZE) {
+		ESP_LOGE(TAG, "%s passt nicht in einen Slot (%lu Bytes Code)", name, (unsigned long)hdr.text_size);
+		esp_elf_deinit(&elf);
+		xSemaphoreGive(app_xip_lock);
+		return -5;
+	}
+
+	// Zuerst löschen, damit ein abgebrochener Vorgang keinen gültigen Kopf hinterlässt
+	size_t base = slot * APP_XIP_SLOT_SIZE;
+	memset(&app_xip_hdr[slot], 0, sizeof(AppXipHeader));
+	esp_err_t err = esp_partition_erase_range(app_xip_part, base, APP_XIP_SLOT_SIZE);
+	if (err == ESP_OK) {
+		err = esp_partition_write(app_xip_part, base + APP_XIP_HEADER_SIZE, elf.ptext, hdr.text_size);
+	}
+	if (err == ESP_OK && hdr.data_size) {
+		err = esp_partition_write(app_xip_part, base + app_xip_data_offset(&hdr), elf.pdata, hdr.data_size);
+	}
+	if (err == ESP_OK) {
+		err = esp_partition_write(app_xip_part, base, &hdr, sizeof(hdr));
+	}
+	esp_elf_deinit(&elf);
+	if (err != ESP_OK) {
+		ESP_LOGE(TAG, "Schreiben von Slot %d fehlgeschlagen (%s)", slot, esp_err_to_name(err));
+		xSemaphoreGive(app_xip_lock);
+		return -6;
+	}
+	app_xip_hdr[slot] = hdr;
+	xSemaphoreGive(app_xip_lock);
+	ESP_LOGI(TAG, "%s in Slot %d installiert, %lu Bytes Code, %lu Bytes Daten", name, slot,
+		(unsigned long)hdr.text_size, (unsigned long)hdr.data_size);
+	return slot;
+}
+
+// Löscht eine installierte App. Liefert 0, -1 (nicht installiert) oder -2 (läuft).
+int app_xip_remove(const char *name) {
+	if (app_xip_lock == NULL) {
+		return -1;
+	}
+	xSemaphoreTake(app_xip_lock, portMAX_DELAY);
+	int slot = app_xip_find(name);
+	int ret = 0;
+	if (slot < 0) {
+		ret = -1;
+	} else if (app_xip_in_use[slot]) {
+		ret = -2;
+	} else {
+		esp_partition_erase_range(app_xip_part, slot * APP_XIP_SLOT_SIZE, APP_XIP_HEADER_SIZE);
+		memset(&app_xip_hdr[slot], 0, sizeof(AppXipHeader));
+	}
+	xSemaphoreGive(app_xip_lock);
+	return ret;
+}
+
+// Bereitet den Start einer installierten App vor: das Datenabbild wird in den festen
+// Datenbereich kopiert, der Code läuft direkt aus dem Flash. Liefert den Slot, der
+// mit app_xip_release zurückgegeben werden muss, oder -1, wenn nichts Gültiges
+// installiert ist.
+int app_xip_get(const char *name, time_t mtime, long size, esp_elf_t *elf) {
+	if (app_xip_lock == NULL) {
+		return -1;
+	}
+	xSemaphoreTake(app_xip_lock, portMAX_DELAY);
+	int slot = app_xip_find(name);
+	if (slot < 0 || app_xip_in_use[slot] || !app_xip_valid(slot, mtime, size)) {
+		if (slot >= 0 && !app_xip_in_use[slot]) {
+			ESP_LOGW(TAG, "Slot %d (%s) ist veraltet, bitte neu installieren", slot, name);
+		}
+		xSemaphoreGive(app_xip_lock);
+		return -1;
+	}
+	const AppXipHeader *hdr = &app_xip_hdr[slot];
+	if (hdr->data_size && esp_partition_read(app_xip_part, slot * APP_XIP_SLOT_SIZE + app_xip_data_offset(hdr),
+			app_xip_arena[slot], hdr->data_size) != ESP_OK) {
+		xSemaphoreGive(app_xip_lock);
+		return -1;
+	}
+	esp_elf_init(elf);
+	elf->entry = (void *)(uintptr_t)hdr->entry;
+	app_xip_in_use[slot] = 1;
+	xSemaphoreGive(app_xip_lock);
+	return slot;
+}
+
+void app_xip_release(int slot) {
+	if (app_xip_lock == NULL || slot < 0 || slot >= app_xip_slots) {
+		return;
+	}
+	xSemaphoreTake(app_xip_lock, portMAX_DELAY);
+	app_xip_in_use[slot] = 0;
+	xSemaphoreGive(app_xip_lock);
+}
+
+void app_xip_print(void) {
+	if (app_xip_lock == NULL) {
+		printf("Keine Partition \"%s\"\n", APP_XIP_PARTITION);
+		return;
+	}
+	printf("Slot  Name                Code    Daten  Status\n");
+	xSemaphoreTake(app_xip_lock, portMAX_DELAY);
+	for (int i = 0; i < app_xip_slots; i++) {
+		const AppXipHeader *hdr = &app_xip_hdr[i];
+		if (hdr->magic != APP_XIP_MAGIC) {
+			continue;
+		}
+		// Stand der ELF-Datei wird erst beim Start geprüft
+		int current = app_xip_valid(i, hdr->mtime, hdr->size);
+		printf("%4d  %-18s %6lu %7lu  %s\n", i, hdr->name, (unsigned long)hdr->text_size,
+			(unsigned long)hdr->data_size, app_xip_in_use[i] ? "läuft" : (current ? "bereit" : "veraltet"));
+	}
+	xSemaphoreGive(app_xip_lock);
+}
@@ -24,6 +24,7 @@
 #include "esp_log.h"
 #include "i2c_lib.h"
 #include "pin_def.h"
+#include "private/elf_symbol.h"
 
 #include "freertos/semphr.h"
 #include "freertos/queue.h"
@@ -47,6 +48,9 @@ SemaphoreHandle_t GyroMutex = NULL;
 
 #define NVS_NAMESPACE "MPU6500"
 
+// Namensraum, unter dem der Treiber seine Funktionen für Apps exportiert
+#define I2C_SYMBOL_NS "i2c"
+
 esp_err_t save_calibration(int16_t *accel_offset, int16_t *gyro_offset) {
 	nvs_handle_t handle;
 	esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &handle);
@@ -233,6 +237,18 @@ static esp_err_t i2c_master_init(void)
 }
 
 
+// Direkter Zugriff auf den Sensor für Apps, ohne Umweg über die OS-Wrapper
+static const struct esp_elfsym i2c_symbols[] = {
+	ESP_ELFSYM_EXPORT(mpu6500_register_read),
+	ESP_ELFSYM_EXPORT(mpu6500_register_write_byte),
+	ESP_ELFSYM_EXPORT(mpu6500_read_accel_raw),
+	ESP_ELFSYM_EXPORT(mpu6500_read_gyro_raw),
+	ESP_ELFSYM_EXPORT(mpu6500_convert_data),
+	ESP_ELFSYM_EXPORT(mpu6500_accel),
+	ESP_ELFSYM_EXPORT(mpu6500_gyro),
+	ESP_ELFSYM_END
+};
+
 void i2c_init()
 {
 	uint8_t data[2];
@@ -275,10 +291,16 @@ void i2c_init()
 		ESP_LOGI("MPU6500", "Accel: X=%d Y=%d Z=%d", accel_offset[0], accel_offset[1], accel_offset[2]);
 		ESP_LOGI("MPU6500", "Gyro:  X=%d Y=%d Z=%d", gyro_offset[0], gyro_offset[1], gyro_offset[2]);
 	}
+
+	// Erst exportieren, wenn der Sensor bereit ist
+	if (elf_register_symbols(i2c_symbols, I2C_SYMBOL_NS) != 0) {
+		ESP_LOGW(TAG, "I2C symbols could not be exported");
+	}
 }
 
 void i2c_close()
 {
+	elf_unregister_symbols(I2C_SYMBOL_NS);
 	ESP_ERROR_CHECK(i2c_driver_delete(I2C_MASTER_NUM));
 	ESP_LOGI(TAG, "I2C de-initialized successfully");
 }
\ No newline at end of file
@@ -0,0 +1,8 @@
+#ifndef APP_AUTOSTART
+#define APP_AUTOSTART
+
+#define APP_AUTOSTART_PATH "/spiffs/autostart.json"
+
+int app_autostart_init(void);
+
+#endif
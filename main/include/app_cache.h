@@ -0,0 +1,25 @@
+#ifndef APP_CACHE
+#define APP_CACHE
+
+#include <stdint.h>
+#include <time.h>
+#include "esp_elf.h"
+
+// Ein fertig reloziertes App-Image im Cache
+typedef struct {
+	char path[64];        // Pfad der ELF-Datei
+	time_t mtime;         // Änderungszeit der Datei beim Laden
+	long size;            // Dateigröße beim Laden
+	esp_elf_t elf;        // Relozierte Sektionen und Einsprungpunkt (gehört dem Cache)
+	uint8_t *data_copy;   // Unberührte Kopie von .data direkt nach der Relokation
+	uint8_t in_use;       // 1 = eine laufende App verwendet das Image
+	uint32_t last_used;   // LRU-Zeitstempel
+} AppImage_t;
+
+void app_cache_init(void);
+AppImage_t *app_cache_get(const char *path, time_t mtime, long size);
+AppImage_t *app_cache_put(const char *path, time_t mtime, long size, const esp_elf_t *elf);
+void app_cache_release(AppImage_t *image);
+int app_cache_trim(void);
+
+#endif
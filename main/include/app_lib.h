@@ -0,0 +1,17 @@
+#ifndef APP_LIB
+#define APP_LIB
+
+// Bibliotheken liegen als /spiffs/lib/<name>.elf im Dateisystem
+#define APP_LIB_PATH "/spiffs/lib/"
+#define APP_LIB_EXT  ".elf"
+#define APP_LIB_NAME_LEN 16
+
+struct esp_elfsym_scope;
+
+int app_lib_init(void);
+int app_lib_acquire(const char *name);
+void app_lib_release(int lib);
+int app_lib_scope(int lib, struct esp_elfsym_scope *scope);
+void app_lib_print(void);
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef APP_MANIFEST
+#define APP_MANIFEST
+
+#include <stdint.h>
+#include "app_lib.h"
+
+#define APP_MANIFEST_EXT ".json"
+#define APP_MANIFEST_MAX_LIBS 4
+
+// Startparameter einer App aus /spiffs/<app>.json
+typedef struct {
+	uint32_t stack;      // Stackgröße des App-Tasks in Bytes
+	uint8_t priority;    // FreeRTOS-Priorität
+	int core;            // Kern 0/1 oder tskNO_AFFINITY
+	uint32_t heap_caps;  // MALLOC_CAP_* für malloc/calloc/realloc der App
+	uint32_t heap_quota; // Obergrenze für malloc der App in Bytes (0 = unbegrenzt)
+	uint32_t stop_grace; // Wartezeit in ms auf das Beenden nach "exit", danach wird der Task gelöscht
+	char libs[APP_MANIFEST_MAX_LIBS][APP_LIB_NAME_LEN];  // Benötigte Bibliotheken
+	uint8_t lib_count;   // Anzahl der Einträge in libs
+	uint8_t from_file;   // 1 = Werte stammen aus einem Manifest
+} AppManifest_t;
+
+void app_manifest_default(AppManifest_t *manifest);
+int app_manifest_load(const char *elf_path, AppManifest_t *manifest);
+
+#endif
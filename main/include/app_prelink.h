@@ -0,0 +1,16 @@
+#ifndef APP_PRELINK
+#define APP_PRELINK
+
+#include <time.h>
+#include "esp_elf.h"
+
+// Dateiendung der Prelink-Datei neben der ELF-Datei
+#define APP_PRELINK_EXT ".plk"
+
+int app_prelink_load(const char *elf_path, time_t mtime, long size, esp_elf_prelink_t *prelink);
+void app_prelink_record(esp_elf_prelink_t *prelink);
+int app_prelink_save(const char *elf_path, time_t mtime, long size, const esp_elf_prelink_t *prelink);
+void app_prelink_discard(const char *elf_path);
+void app_prelink_free(esp_elf_prelink_t *prelink);
+
+#endif
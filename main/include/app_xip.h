@@ -0,0 +1,19 @@
+#ifndef APP_XIP
+#define APP_XIP
+
+#include <stdint.h>
+#include <time.h>
+#include "esp_elf.h"
+
+// Partition mit den fest installierten Apps (siehe partitions.csv)
+#define APP_XIP_PARTITION "apps"
+#define APP_XIP_SUBTYPE 0x40
+
+int app_xip_init(void);
+int app_xip_install(const char *name, const char *path, time_t mtime, long size);
+int app_xip_remove(const char *name);
+int app_xip_get(const char *name, time_t mtime, long size, esp_elf_t *elf);
+void app_xip_release(int slot);
+void app_xip_print(void);
+
+#endif
@@ -0,0 +1,107 @@
+#ifndef IPC_RING
+#define IPC_RING
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Lock-freier Ringpuffer für einen Producer und einen Consumer. head wird nur vom
+// Producer, tail nur vom Consumer geschrieben, beide laufen frei über und werden
+// erst beim Zugriff auf data maskiert. Der Kern kommt ohne FreeRTOS aus, damit er
+// auf dem Host mit pthreads getestet werden kann (host_test/ipc_ring_test.c);
+// Blockieren und Wecken übernimmt der Aufrufer.
+typedef struct {
+	uint32_t head;          // Schreibposition (Producer)
+	uint32_t tail;          // Leseposition (Consumer)
+	uint32_t size;          // Kapazität in Byte (Zweierpotenz)
+	uint32_t waiting;       // 1 = Consumer schläft und will geweckt werden
+	void *producer;         // Einziger schreibender Task (NULL = noch keiner)
+	void *consumer;         // Einziger lesender Task, wird auch geweckt
+	uint8_t data[];         // Pufferinhalt
+} IPCRing;
+
+// Bindet die Rolle owner (producer oder consumer) beim ersten Zugriff an task.
+// Liefert 0, wenn task die Rolle hat, sonst -1.
+static inline int ipc_ring_claim(void **owner, void *task) {
+	void *expected = NULL;
+	if (__atomic_compare_exchange_n(owner, &expected, task, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+		return 0;
+	}
+	return expected == task ? 0 : -1;
+}
+
+// Gibt die Rolle owner frei, wenn task sie hat
+static inline void ipc_ring_unclaim(void **owner, void *task) {
+	__atomic_compare_exchange_n(owner, &task, NULL, 0, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED);
+}
+
+// Freier Platz in Byte, aus Sicht des Producers
+static inline uint32_t ipc_ring_space(IPCRing *ring) {
+	return ring->size - (__atomic_load_n(&ring->head, __ATOMIC_RELAXED) - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE));
+}
+
+// Schreibt höchstens len Byte, ohne zu blockieren, und liefert die Anzahl
+// geschriebener Bytes. *wake wird 1, wenn der Consumer geweckt werden muss.
+// Darf nur vom Producer aufgerufen werden.
+static inline size_t ipc_ring_put(IPCRing *ring, const void *data, size_t len, int *wake) {
+	uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+	uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+	uint32_t space = ring->size - (head - tail);
+	*wake = 0;
+	if (len > space) {
+		len = space;
+	}
+	if (len == 0) {
+		return 0;
+	}
+	uint32_t off = head & (ring->size - 1);
+	size_t first = (len < ring->size - off) ? len : ring->size - off;
+	memcpy(ring->data + off, data, first);
+	memcpy(ring->data, (const uint8_t *)data + first, len - first);
+
+	// Daten veröffentlichen und danach das Warte-Flag lesen (beides seq_cst, damit
+	// sich Producer und Consumer nicht gegenseitig verpassen). Der Consumer setzt
+	// das Flag nur, wenn er den Ring leer vorgefunden hat, geweckt wird also nur
+	// beim Übergang von leer auf nicht leer.
+	__atomic_store_n(&ring->head, head + len, __ATOMIC_SEQ_CST);
+	if (__atomic_load_n(&ring->waiting, __ATOMIC_SEQ_CST) &&
+			__atomic_exchange_n(&ring->waiting, 0, __ATOMIC_SEQ_CST)) {
+		*wake = 1;
+	}
+	return len;
+}
+
+// Meldet, dass der Consumer schlafen will. Liefert 1, wenn inzwischen Daten da
+// sind und er nicht schlafen darf. Darf nur vom Consumer aufgerufen werden.
+static inline int ipc_ring_prepare_wait(IPCRing *ring) {
+	__atomic_store_n(&ring->waiting, 1, __ATOMIC_SEQ_CST);
+	return __atomic_load_n(&ring->head, __ATOMIC_SEQ_CST) != __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+}
+
+// Beendet das Warten des Consumers
+static inline void ipc_ring_end_wait(IPCRing *ring) {
+	__atomic_store_n(&ring->waiting, 0, __ATOMIC_RELAXED);
+}
+
+// Liest höchstens len Byte, ohne zu blockieren, und liefert die Anzahl gelesener
+// Bytes (0 = leer). Darf nur vom Consumer aufgerufen werden.
+static inline size_t ipc_ring_get(IPCRing *ring, void *buffer, size_t len) {
+	uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+	uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+	uint32_t avail = head - tail;
+	if (len > avail) {
+		len = avail;
+	}
+	if (len == 0) {
+		return 0;
+	}
+	uint32_t off = tail & (ring->size - 1);
+	size_t first = (len < ring->size - off) ? len : ring->size - off;
+	memcpy(buffer, ring->data + off, first);
+	memcpy((uint8_t *)buffer + first, ring->data, len - first);
+	// Platz erst freigeben, nachdem die Daten kopiert sind
+	__atomic_store_n(&ring->tail, tail + len, __ATOMIC_RELEASE);
+	return len;
+}
+
+#endif
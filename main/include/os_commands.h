@@ -6,6 +6,7 @@ int version_cmd(int argc, char **argv);
 int handle_update_server(int argc, char **argv);
 int update(int argc, char **argv);
 int get_task_list_cmd(int argc, char **argv);
+int top_cmd(int argc, char **argv);
 int startApp_cmd(int argc, char **argv);
 int stopApp_cmd(int argc, char **argv);
 int move_cmd(int argc, char **argv);
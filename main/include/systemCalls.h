@@ -1,6 +1,42 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// Nachricht für die Batch-Systemcalls
+typedef struct {
+	void *data;   // Nachricht bzw. Empfangspuffer
+	size_t len;   // Länge der Nachricht bzw. Größe des Empfangspuffers
+} IPCMsg_t;
+
+// Ergebnis eines Ladeauftrags an den App-Loader
+typedef struct {
+	int status;         // 1 = App gestartet, sonst Fehlercode wie registerApp
+	int slot;           // Vergebener App-Slot (-1 = keiner)
+	int id;             // App-ID für app_find/unregisterAppId (-1 = keine)
+	uint32_t wait_us;   // Wartezeit in der Auftragswarteschlange
+	uint32_t load_us;   // Lesen und Relozieren
+	uint32_t total_us;  // Vom Auftrag bis zum Start des App-Tasks
+} AppLoadResult_t;
+
+// Ergebnis von app_stop
+typedef struct {
+	int status;         // 1 = App beendet, sonst Fehlercode wie app_stop
+	uint8_t forced;     // 1 = App hat nicht reagiert, Task wurde gelöscht
+	uint32_t stop_us;   // Vom "exit" bis zur Freigabe des Slots
+} AppStopResult_t;
+
+// Ereignisse für sys_poll
+#define IPC_POLLIN   0x01  // Nachricht zum Abholen vorhanden
+#define IPC_POLLNVAL 0x20  // fd ungültig
+
+// Eintrag für sys_poll
+typedef struct {
+	int fd;         // Zu überwachende Queue
+	short events;   // Gewünschte Ereignisse
+	short revents;  // Eingetretene Ereignisse
+} IPCPollFd_t;
 
 // OS-Implementierungen der Systemcalls
 int sys_openqueue(const char *name);
@@ -8,6 +44,36 @@ int sys_findqueue(const char *name);
 int sys_closequeue(int fd);
 int sys_sendmsg(int fd, const char *msg, size_t len);
 int sys_recvmsg(int fd, char *buffer, size_t len);
+int sys_openqueue_buf(const char *name, size_t capacity);
+int sys_recvmsg_len(int fd, void *buffer, size_t len);
+int sys_sendmsg_batch(int fd, const IPCMsg_t msgs[], size_t n);
+int sys_recvmsg_batch(int fd, IPCMsg_t out[], size_t max, int timeout_ms);
+int sys_sendmsg_timeout(int fd, const char *msg, size_t len, int timeout_ms);
+int sys_recvmsg_timeout(int fd, char *buffer, size_t len, int timeout_ms);
+int sys_sendmsg_nb(int fd, const char *msg, size_t len);
+int sys_recvmsg_nb(int fd, char *buffer, size_t len);
+int sys_poll(IPCPollFd_t fds[], size_t n, int timeout_ms);
+int sys_openqueue_zc(const char *name);
+void *sys_msg_alloc(size_t len);
+int sys_msg_release(void *msg);
+int sys_sendmsg_zc(int fd, void *msg, size_t len);
+void *sys_recvmsg_zc(int fd, size_t *len);
+int sys_subscribe(const char *topic);
+int sys_unsubscribe(int fd);
+int sys_publish(const char *topic, const void *msg, size_t len);
+int sys_sub_drops(int fd);
+int sys_ring_open(const char *name, size_t size);
+int sys_ring_write(int fd, const void *data, size_t len);
+int sys_ring_read(int fd, void *buffer, size_t len, int timeout_ms);
+int sys_call(int fd, const void *req, size_t req_len, void *reply, size_t reply_len, int timeout_ms);
+int sys_rpc_recv(int fd, void *req, size_t len, int *call_id, int timeout_ms);
+int sys_rpc_reply(int call_id, const void *reply, size_t len);
+void *sys_shm_open(const char *name, size_t size);
+int sys_shm_close(void *mem);
+void sys_seq_write_begin(uint32_t *seq);
+void sys_seq_write_end(uint32_t *seq);
+uint32_t sys_seq_read_begin(const uint32_t *seq);
+int sys_seq_read_retry(const uint32_t *seq, uint32_t start);
 uint16_t getAppsRunning();
 int8_t init_systemcalls();
 void sys_led(int value);
@@ -25,13 +91,25 @@ void printString(const char *string);
 void printChar(char c);
 void printFloat(float f);
 void printNewLine();
+int app_printf(const char *format, ...);
+int app_fprintf(FILE *stream, const char *format, ...);
 
 //OS Functions
 uint16_t getAppsRunning();
-void start_app();
+void start_app(void *arg);
 int16_t checkAppRegister(const char *filename);
+int app_find(const char *appname);
+int app_of_task(TaskHandle_t task, char *name, size_t len);
+int unregisterAppId(int id);
+int app_stop(int id, int grace_ms, AppStopResult_t *result);
 int16_t findFreeAppSlot();
 int registerApp(const char *filename);
+int app_load_async(const char *appname, TaskHandle_t notify, AppLoadResult_t *result);
 int unregisterApp(const char *filename);
 int printAppList(int argc, char **argv);
+void print_app_heap();
+int ipc_bench_cmd(int argc, char **argv);
+int ipc_stat_cmd(int argc, char **argv);
+int app_bench_cmd(int argc, char **argv);
+int app_install_cmd(int argc, char **argv);
 void initApps();
\ No newline at end of file
@@ -27,6 +27,7 @@
 #include "i2c_lib.h"
 #include "http_ota.h"
 #include "systemCalls.h"
+#include "app_autostart.h"
 #include "os_commands.h"
 
 #include "pin_def.h"
@@ -162,6 +163,7 @@ void app_main(void) {
 	init_spiffs();
 	init_systemcalls();
 	initApps();
+	app_autostart_init();
 	
 	wifi_init_sta();
 	//start_webserver();
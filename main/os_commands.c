@@ -21,8 +21,15 @@
 #include "esp_spiffs.h"
 #include "esp_system.h"
 #include <stdio.h>      // Für printf() und perror()
+#include <stdlib.h>
 #include <dirent.h> 
 
+// Reserve im Task-Abbild für Tasks, die während des Auslesens entstehen
+#define TASK_SNAPSHOT_SPARE   4
+// Voreinstellungen für top: Messfenster in Sekunden und Anzahl der Ausgaben
+#define TOP_DEFAULT_INTERVAL  2
+#define TOP_DEFAULT_ROUNDS    5
+
 esp_console_cmd_t version_command = {
 	.command = "version",
 	.help = "Zeigt die Version des ESP32 OS",
@@ -51,6 +58,13 @@ esp_console_cmd_t taskList_command = {
 	.func = &get_task_list_cmd,
 };
 
+esp_console_cmd_t top_command = {
+	.command = "top",
+	.help = "Zeigt die CPU-Last je Kern, Task und App",
+	.hint = "[intervall_s] [anzahl]",
+	.func = &top_cmd,
+};
+
 esp_console_cmd_t appList_command = {
 	.command = "applist",
 	.help = "Zeigt eine Liste der Apps",
@@ -58,17 +72,45 @@ esp_console_cmd_t appList_command = {
 	.func = &printAppList,
 };
 
+esp_console_cmd_t ipcBench_command = {
+	.command = "ipcbench",
+	.help = "Misst die Kosten der IPC-Systemcalls",
+	.hint = "[batch] [iterations]",
+	.func = &ipc_bench_cmd,
+};
+
+esp_console_cmd_t ipcStat_command = {
+	.command = "ipcstat",
+	.help = "Zeigt Zähler und Latenzen der IPC-Queues",
+	.hint = "[reset]",
+	.func = &ipc_stat_cmd,
+};
+
+esp_console_cmd_t appBench_command = {
+	.command = "appbench",
+	.help = "Vergleicht die Ladezeit einer App ohne und mit Prelink-Datei",
+	.hint = "<app> [durchläufe]",
+	.func = &app_bench_cmd,
+};
+
+esp_console_cmd_t appInstall_command = {
+	.command = "appinstall",
+	.help = "Installiert eine App in die App-Partition, der Code läuft dann aus dem Flash",
+	.hint = "[<app> | -r <app>]",
+	.func = &app_install_cmd,
+};
+
 esp_console_cmd_t startApp_command = {
 	.command = "start",
-	.help = "Startet eine App",
-	.hint = NULL,
+	.help = "Startet eine oder mehrere Apps im Hintergrund",
+	.hint = "<app> [app ...]",
 	.func = &startApp_cmd,
 };
 
 esp_console_cmd_t stopApp_command = {
 	.command = "stop",
-	.help = "Stoppt eine App",
-	.hint = NULL,
+	.help = "Stoppt eine App, reagiert sie nicht innerhalb der Wartezeit, wird ihr Task gelöscht",
+	.hint = "<app> [wartezeit_ms]",
 	.func = &stopApp_cmd,
 };
 
@@ -161,11 +203,27 @@ int update(int argc, char **argv) {
 	return 0;
 }
 
+// Liest den Zustand aller Tasks in ein passend großes Array (mit Reserve für Tasks,
+// die währenddessen entstehen). Muss mit free() freigegeben werden.
+static TaskStatus_t *get_task_snapshot(UBaseType_t *count, configRUN_TIME_COUNTER_TYPE *total) {
+	UBaseType_t size = uxTaskGetNumberOfTasks() + TASK_SNAPSHOT_SPARE;
+	TaskStatus_t *list = malloc(size * sizeof(TaskStatus_t));
+	if (list == NULL) {
+		*count = 0;
+		return NULL;
+	}
+	*count = uxTaskGetSystemState(list, size, total);
+	return list;
+}
+
 int get_task_list_cmd(int argc, char **argv) {
-	TaskStatus_t task_list[20];  // Platz für 20 Tasks
 	UBaseType_t task_count, i;
-
-	task_count = uxTaskGetSystemState(task_list, 20, NULL);
+	configRUN_TIME_COUNTER_TYPE total;
+	TaskStatus_t *task_list = get_task_snapshot(&task_count, &total);
+	if (task_list == NULL) {
+		printf("Nicht genug Speicher\n");
+		return 1;
+	}
 
 	printf("Tasks aktiv: %d davon %d App\n", uxTaskGetNumberOfTasks(), getAppsRunning());
 	printf("Task Name       State      Prio  Stack  Core\n");
@@ -190,24 +248,177 @@ int get_task_list_cmd(int argc, char **argv) {
 			   task_list[i].usStackHighWaterMark,
 			   core_id);
 	}
+	free(task_list);
+	return 0;
+}
+
+// --- top ---
+
+// CPU-Zeit eines Tasks im Messfenster
+typedef struct {
+	TaskStatus_t *task;
+	uint32_t delta;
+	int app_id;
+	char app[16];
+} TopEntry;
+
+static int top_compare(const void *a, const void *b) {
+	uint32_t da = ((const TopEntry *)a)->delta;
+	uint32_t db = ((const TopEntry *)b)->delta;
+	return da < db ? 1 : (da > db ? -1 : 0);
+}
+
+// Sucht einen Task im vorherigen Abbild über seine Tasknummer
+static TaskStatus_t *top_find(TaskStatus_t *list, UBaseType_t count, UBaseType_t number) {
+	for (UBaseType_t i = 0; i < count; i++) {
+		if (list[i].xTaskNumber == number) {
+			return &list[i];
+		}
+	}
+	return NULL;
+}
+
+// Gibt die CPU-Last je Kern, je Task und je App für ein Messfenster aus
+static void top_print(TaskStatus_t *before, UBaseType_t before_count, configRUN_TIME_COUNTER_TYPE before_total,
+		TaskStatus_t *after, UBaseType_t after_count, configRUN_TIME_COUNTER_TYPE after_total) {
+	uint32_t window = (uint32_t)(after_total - before_total);
+	if (window == 0) {
+		return;
+	}
+	TopEntry *entries = calloc(after_count, sizeof(TopEntry));
+	if (entries == NULL) {
+		return;
+	}
+
+	// Last je Kern aus der Laufzeit der Idle-Tasks
+	float idle[portNUM_PROCESSORS] = {0};
+	for (UBaseType_t i = 0; i < after_count; i++) {
+		TaskStatus_t *prev = top_find(before, before_count, after[i].xTaskNumber);
+		entries[i].task = &after[i];
+		entries[i].delta = (uint32_t)(after[i].ulRunTimeCounter - (prev != NULL ? prev->ulRunTimeCounter : 0));
+		entries[i].app_id = app_of_task(after[i].xHandle, entries[i].app, sizeof(entries[i].app));
+		for (int core = 0; core < portNUM_PROCESSORS; core++) {
+			if (after[i].xHandle == xTaskGetIdleTaskHandleForCore(core)) {
+				idle[core] = 100.0f * entries[i].delta / window;
+			}
+		}
+	}
+	qsort(entries, after_count, sizeof(TopEntry), top_compare);
+
+	printf("\nFenster %lu ms, %d Tasks, %d Apps\n", (unsigned long)(window / 1000), (int)after_count, getAppsRunning());
+	for (int core = 0; core < portNUM_PROCESSORS; core++) {
+		printf("CPU%d: %5.1f %%   ", core, 100.0f - idle[core]);
+	}
+	printf("\n%-16s %-16s %4s %4s %6s %7s\n", "Task", "App", "Prio", "Kern", "CPU %", "Stack");
+	for (UBaseType_t i = 0; i < after_count; i++) {
+		TaskStatus_t *t = entries[i].task;
+		char core[4];
+		if (t->xCoreID >= 0 && t->xCoreID < portNUM_PROCESSORS) {
+			snprintf(core, sizeof(core), "%d", (int)t->xCoreID);
+		} else {
+			strcpy(core, "-");
+		}
+		printf("%-16s %-16s %4d %4s %6.1f %7lu\n", t->pcTaskName, entries[i].app_id >= 0 ? entries[i].app : "-",
+			(int)t->uxCurrentPriority, core, 100.0f * entries[i].delta / window, (unsigned long)t->usStackHighWaterMark);
+	}
+
+	// Nach Apps zusammengefasst (die Liste ist nach Last sortiert, die erste Zeile
+	// einer App sammelt die Summe)
+	if (getAppsRunning() > 0) {
+		printf("%-16s %5s %6s\n", "App", "Tasks", "CPU %");
+		for (UBaseType_t i = 0; i < after_count; i++) {
+			if (entries[i].app_id < 0) {
+				continue;
+			}
+			uint32_t sum = 0;
+			int tasks = 0;
+			int first = 1;
+			for (UBaseType_t j = 0; j < after_count; j++) {
+				if (entries[j].app_id != entries[i].app_id) {
+					continue;
+				}
+				if (j < i) {
+					first = 0;
+					break;
+				}
+				sum += entries[j].delta;
+				tasks++;
+			}
+			if (first) {
+				printf("%-16s %5d %6.1f\n", entries[i].app, tasks, 100.0f * sum / window);
+			}
+		}
+	}
+	free(entries);
+}
+
+int top_cmd(int argc, char **argv) {
+	int interval = TOP_DEFAULT_INTERVAL;
+	int rounds = TOP_DEFAULT_ROUNDS;
+	if (argc > 1) {
+		interval = atoi(argv[1]);
+	}
+	if (argc > 2) {
+		rounds = atoi(argv[2]);
+	}
+	if (interval < 1 || rounds < 1) {
+		printf("Usage: top [intervall_s] [anzahl]\n");
+		return 1;
+	}
+
+	UBaseType_t before_count;
+	configRUN_TIME_COUNTER_TYPE before_total;
+	TaskStatus_t *before = get_task_snapshot(&before_count, &before_total);
+	if (before == NULL) {
+		printf("Nicht genug Speicher\n");
+		return 1;
+	}
+	for (int round = 0; round < rounds; round++) {
+		vTaskDelay(pdMS_TO_TICKS(interval * 1000));
+		UBaseType_t after_count;
+		configRUN_TIME_COUNTER_TYPE after_total;
+		TaskStatus_t *after = get_task_snapshot(&after_count, &after_total);
+		if (after == NULL) {
+			break;
+		}
+		top_print(before, before_count, before_total, after, after_count, after_total);
+		free(before);
+		before = after;
+		before_count = after_count;
+		before_total = after_total;
+	}
+	free(before);
 	return 0;
 }
 
 int startApp_cmd(int argc, char **argv) {
 	if(argc < 2) {
-		printf("Usage: startapp <appname>\n");
+		printf("Usage: start <appname> [appname ...]\n");
 		return 1;
 	}
-	registerApp(argv[1]);
+	// Der Loader arbeitet die Aufträge im Hintergrund ab und meldet das Ergebnis im Log
+	for(int i = 1; i < argc; i++) {
+		if(app_load_async(argv[i], NULL, NULL) != 0) {
+			printf("App %s konnte nicht eingereiht werden\n", argv[i]);
+		}
+	}
 	return 0;
 }
 
 int stopApp_cmd(int argc, char **argv) {
 	if(argc < 2) {
-		printf("Usage: stopapp <appname>\n");
+		printf("Usage: stop <appname> [wartezeit_ms]\n");
 		return 1;
 	}
-	unregisterApp(argv[1]);
+	// Ohne Angabe gilt die Wartezeit aus dem Manifest der App
+	int grace_ms = (argc > 2) ? atoi(argv[2]) : -1;
+	AppStopResult_t res;
+	if (app_stop(app_find(argv[1]), grace_ms, &res) < 0) {
+		printf("App %s %s\n", argv[1], res.status == -2 ? "wird gerade geladen oder beendet" : "nicht gefunden");
+		return 1;
+	}
+	printf("App %s nach %lu ms beendet%s\n", argv[1], (unsigned long)(res.stop_us / 1000),
+		res.forced ? " (Task gelöscht)" : "");
 	return 0;
 }
 
@@ -306,6 +517,10 @@ void print_heap_info() {
 int free_mem_cmd(int argc, char **argv) {
 	printf("Free Memory:\n");
 	print_heap_info();
+	if (getAppsRunning() > 0) {
+		printf("\nHeap der Apps:\n");
+		print_app_heap();
+	}
 	// printMemorySize(esp_get_free_heap_size());
 	// printf("\n");
 	return 0;
@@ -427,7 +642,12 @@ void register_commands(void)
 	esp_console_cmd_register(&webserver_command);
 	esp_console_cmd_register(&update_command);
 	esp_console_cmd_register(&taskList_command);
+	esp_console_cmd_register(&top_command);
 	esp_console_cmd_register(&appList_command);
+	esp_console_cmd_register(&ipcBench_command);
+	esp_console_cmd_register(&ipcStat_command);
+	esp_console_cmd_register(&appBench_command);
+	esp_console_cmd_register(&appInstall_command);
 	esp_console_cmd_register(&startApp_command);
 	esp_console_cmd_register(&stopApp_command);
 	esp_console_cmd_register(&move_command);
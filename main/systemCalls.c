@@ -1,12 +1,25 @@
 #include "systemCalls.h"
+#include "app_cache.h"
+#include "app_prelink.h"
+#include "app_manifest.h"
+#include "app_lib.h"
+#include "app_xip.h"
+#include "ipc_ring.h"
+#include <stdarg.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <sys/errno.h>
+#include <sys/stat.h>
 #include "driver/gpio.h"
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 #include "freertos/event_groups.h"
 #include "freertos/semphr.h"
 #include "freertos/queue.h"
+#include "freertos/message_buffer.h"
 #include "esp_elf.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "private/elf_symbol.h"
 
 #include "i2c_lib.h"
@@ -19,6 +32,14 @@ static const char *TAG = "APP LOADER";
 #define APP_PATH "/spiffs/"
 #define APP_EXT  ".elf"
 
+// 1 = Apps werden sektionsweise direkt aus der Datei geladen, statt die ganze
+// Datei vorher ins PSRAM zu lesen (spart etwa die Dateigröße an Spitzenspeicher)
+#define APP_LOAD_STREAM 1
+// 1 = Aufgelöste Symboladressen werden in einer Prelink-Datei neben der App
+// gespeichert und bei späteren Starts ohne Symbolsuche übernommen
+#define APP_PRELINK_ENABLE 1
+#define APP_PRELINK_RECORD 2
+
 // System-LED-Steuerung mit Mutex
 SemaphoreHandle_t SysLedMutex = NULL;
 
@@ -28,8 +49,40 @@ SemaphoreHandle_t SysLedMutex = NULL;
 uint8_t SysLedMode = SYS_LED_HEARTBEAT;
 TaskHandle_t SysLed;  // Task-Handle für die LED-Steuerung
 
-// Maximale Anzahl an Apps, die gleichzeitig geladen werden können
-#define MAX_APPS 10
+// Die App-Tabelle wächst blockweise bis APP_MAX_SLOTS. Blöcke werden nie verschoben
+// oder freigegeben, Zeiger auf App-Einträge bleiben also gültig.
+#define APP_CHUNK_SHIFT  3
+#define APP_CHUNK_SIZE   (1 << APP_CHUNK_SHIFT)
+#define APP_MAX_CHUNKS   32
+#define APP_MAX_SLOTS    (APP_CHUNK_SIZE * APP_MAX_CHUNKS)  // muss in uint8_t passen
+#define APP_HASH_BUCKETS 32
+
+// Maximale Anzahl gleichzeitig existierender Shared-Memory-Segmente
+#define MAX_SHM_SEGMENTS 16
+// Versuche mit taskYIELD, bevor ein Seqlock-Leser auf einen Schreiber schlafend wartet
+#define SEQ_READ_SPINS 64
+// Längste Wartescheibe, mit der ein Systemaufruf unter einer Queue-Sperre blockiert,
+// bevor er nachsieht, ob seine App beendet werden soll
+#define APP_SYSCALL_SLICE_MS 10
+
+// Apps bekommen malloc/calloc/realloc/free auf Wrapper umgelenkt. Jeder Block trägt
+// diesen Kopf und hängt in der Liste seiner App, damit app_cleanup alles freigeben kann.
+// Zusätzlich steht jeder Block in einer Hash-Tabelle nach Adresse: free und realloc
+// erkennen daran sicher, ob ein Zeiger von den Wrappern stammt.
+#define APP_TLS_INDEX      1        // Thread-Local-Storage-Index mit dem App-Slot (0 = pthread)
+#define APP_HEAP_NO_OWNER  0xFFFF
+#define APP_HEAP_HASH_BITS 8        // 256 Buckets
+
+// Bit in App_t.events: der Einsprungpunkt der App ist zurückgekehrt
+#define APP_EVT_EXITED (1 << 0)
+
+typedef struct AppAlloc {
+	struct AppAlloc *next;   // Liste der Blöcke einer App
+	struct AppAlloc *prev;
+	struct AppAlloc *hash_next;  // Bucket in app_heap_hash
+	uint32_t size;           // Angeforderte Größe
+	uint16_t slot;           // Besitzer oder APP_HEAP_NO_OWNER
+} AppAlloc;
 
 // Struktur zur Verwaltung laufender Apps
 typedef struct {
@@ -39,15 +92,123 @@ typedef struct {
 	uint8_t *exec_mem;       // Zeiger auf den ausführbaren Speicher
 	char *name;              // Name der App
 	uint8_t running;         // Status der App (0 = gestoppt, 1 = laufend)
-	uint8_t id;			  	// ID der App
-	uint8_t stderror;		// File-Descriptor für Standardfehlerausgabe
+	int id;			  	// File-Descriptor der Eingabe-Queue (stdin)
+	int stderror;		// File-Descriptor für Standardfehlerausgabe
+	AppImage_t *image;       // Image aus dem Cache (NULL = eigene Sektionen in elf)
+	int8_t xip_slot;         // Slot in der App-Partition, aus dem der Code läuft (-1 = RAM)
+	time_t file_mtime;       // Änderungszeit der ELF-Datei beim Registrieren
+	long file_size;          // Größe der ELF-Datei beim Registrieren
+	AppManifest_t manifest;  // Startparameter aus <app>.json
+	uint16_t gen;            // Generation des Slots, Teil der App-ID
+	int16_t hash_next;       // Nächster Slot im Namens-Bucket bzw. in der Freiliste
+	int16_t live_prev;       // Liste der belegten Slots
+	int16_t live_next;
+	uint8_t shm_refs[MAX_SHM_SEGMENTS];  // Geöffnete Shared-Memory-Segmente
+	AppAlloc *allocs;        // Noch belegte Heap-Blöcke der App
+	uint32_t heap_live;      // Belegte Bytes
+	uint32_t heap_peak;      // Höchststand der belegten Bytes
+	uint32_t heap_count;     // Anzahl der Allokationen seit dem Start
+	uint32_t heap_fails;     // An der Quote gescheiterte Allokationen
+	int8_t libs[APP_MANIFEST_MAX_LIBS];  // Handles der verwendeten Bibliotheken
+	uint8_t lib_count;       // Anzahl der Einträge in libs
+	EventGroupHandle_t events;  // Beenden-Protokoll, bleibt beim Slot erhalten
+	uint8_t exiting;         // Einsprungpunkt zurückgekehrt oder Task wird gelöscht
+	uint8_t stopping;        // Ein anderer Task beendet die App und räumt auf
+	uint8_t in_syscall;      // Verschachtelte Systemaufrufe, die gerade eine OS-Sperre halten
+	uint8_t kill_pending;    // Task hält an, sobald er den Systemaufruf verlässt
 } App_t;
 
-// Array zur Verwaltung aller Apps
-App_t Apps[MAX_APPS];
-int16_t AppStartCount = 0; // Zähler für gestartete Apps
+// App-ID: Slot in den unteren 8 Bit, Generation darüber. Eine ID wird ungültig,
+// sobald der Slot freigegeben wird.
+#define APP_ID(slot, gen) ((int)(((gen) & 0x7FFF) << 8 | (slot)))
+#define APP_ID_SLOT(id)   ((id) & 0xFF)
+#define APP_ID_GEN(id)    (((id) >> 8) & 0x7FFF)
+
+// Zugriff auf den Eintrag eines Slots
+#define APP(slot) (&app_chunks[(slot) >> APP_CHUNK_SHIFT][(slot) & (APP_CHUNK_SIZE - 1)])
+
+// Tabelle zur Verwaltung aller Apps
+static App_t *app_chunks[APP_MAX_CHUNKS];
+static uint16_t app_slots = 0;              // Angelegte Slots
+static int16_t app_hash[APP_HASH_BUCKETS];  // Namensindex der belegten Slots
+static int16_t app_free_list = -1;          // Freiliste
+static int16_t app_live = -1;               // Belegte Slots
+static portMUX_TYPE app_lock = portMUX_INITIALIZER_UNLOCKED;
 uint16_t AppCount = 0;     // Gesamtanzahl geladener Apps
 
+// Liefert den Slot der App, zu deren Haupttask der Aufrufer gehört, oder -1
+static int app_self(void) {
+	uintptr_t tag = (uintptr_t)pvTaskGetThreadLocalStoragePointer(NULL, APP_TLS_INDEX);
+	return tag == 0 ? -1 : (int)(tag - 1);
+}
+
+// Klammern Systemaufrufe, die Sperren des ganzen Systems nehmen (Shared Memory, LED,
+// Sensor, Konsole, Sende-/Empfangssperren der Message-Buffer-Queues). Solange eine
+// App darin steckt, löscht app_stop ihren Task nicht, sondern der Task hält beim
+// Verlassen des Aufrufs selbst an. Andere Tasks zählen nicht.
+static int app_syscall_enter(void) {
+	int slot = app_self();
+	if (slot < 0) {
+		return -1;
+	}
+	taskENTER_CRITICAL(&app_lock);
+	APP(slot)->in_syscall++;
+	taskEXIT_CRITICAL(&app_lock);
+	return slot;
+}
+
+static void app_syscall_leave(int slot) {
+	if (slot < 0) {
+		return;
+	}
+	App_t *app = APP(slot);
+	taskENTER_CRITICAL(&app_lock);
+	uint8_t park = --app->in_syscall == 0 && app->kill_pending;
+	taskEXIT_CRITICAL(&app_lock);
+	if (park) {
+		// app_stop wartet darauf und löscht den Task
+		xEventGroupSetBits(app->events, APP_EVT_EXITED);
+		vTaskSuspend(NULL);
+	}
+}
+
+// Nächste Wartescheibe für einen Aufruf, der zwischen app_syscall_enter und
+// app_syscall_leave blockiert und ab start höchstens ticks warten darf. Liefert 0,
+// wenn die Zeit abgelaufen ist oder app_stop die App beenden will, sonst 1 und die
+// Scheibe in *wait. So hält ein blockierter Aufruf keine Sperre länger als
+// APP_SYSCALL_SLICE_MS über das Beenden hinaus.
+static int app_syscall_wait(int slot, TickType_t start, TickType_t ticks, TickType_t *wait) {
+	if (slot >= 0 && __atomic_load_n(&APP(slot)->kill_pending, __ATOMIC_RELAXED)) {
+		return 0;
+	}
+	TickType_t left = portMAX_DELAY;
+	if (ticks != portMAX_DELAY) {
+		TickType_t elapsed = xTaskGetTickCount() - start;
+		if (elapsed >= ticks) {
+			return 0;
+		}
+		left = ticks - elapsed;
+	}
+	TickType_t slice = pdMS_TO_TICKS(APP_SYSCALL_SLICE_MS);
+	if (slice == 0) {
+		slice = 1;
+	}
+	*wait = left < slice ? left : slice;
+	return 1;
+}
+
+// Nimmt eine Sperre in Scheiben, siehe app_syscall_wait
+static int app_syscall_take(int slot, SemaphoreHandle_t lock, TickType_t ticks) {
+	const TickType_t start = xTaskGetTickCount();
+	TickType_t wait = 0;
+	do {
+		if (xSemaphoreTake(lock, wait) == pdTRUE) {
+			return 0;
+		}
+	} while (app_syscall_wait(slot, start, ticks, &wait));
+	return -1;
+}
+
 // --- Interprozesskommunikation (IPC) ---
 
 // Maximale Anzahl von IPC-Queues
@@ -56,21 +217,224 @@ uint16_t AppCount = 0;     // Gesamtanzahl geladener Apps
 #define IPC_MSG_MAX_LEN 64
 // Maximale Länge eines Queue-Namens
 #define MAX_QUEUE_NAME_LEN 16
+// Anzahl der Nachrichten, die eine Queue aufnehmen kann
+#define IPC_QUEUE_DEPTH 10
+// Wartezeit beim Senden und Empfangen
+#define IPC_TIMEOUT_MS 2000
+
+// Queue-Typen
+#define IPC_QUEUE_FIXED 0  // Nachrichten werden in Slots zu IPC_MSG_MAX_LEN Byte kopiert
+#define IPC_QUEUE_ZC    1  // Es wird nur ein Zeiger auf einen IPCBuffer übertragen
+#define IPC_QUEUE_BUF   2  // Message-Buffer, Nachrichten variabler Länge mit Längenpräfix
+#define IPC_QUEUE_RING  3  // Lock-freier Byte-Ring für genau einen Sender und einen Empfänger
+
+// Maximale Anzahl Nachrichten, die ein Batch bei angehaltenem Scheduler einreiht
+#define IPC_BATCH_CHUNK 16
+
+// Zusätzlicher Platzbedarf einer Nachricht im Message-Buffer (Längenpräfix)
+#define IPC_BUF_MSG_OVERHEAD sizeof(size_t)
+
+// Aufbau eines File-Descriptors: die unteren 8 Bit sind der Index in ipc_queues,
+// darüber liegt die Generation des Slots. Nach dem Schließen einer Queue wird die
+// Generation erhöht, sodass veraltete fds sofort als ungültig erkannt werden.
+#define IPC_FD_INDEX_BITS 8
+#define IPC_FD_INDEX_MASK ((1 << IPC_FD_INDEX_BITS) - 1)
+#define IPC_FD_GEN_MASK   0x7FFF
+#define IPC_FD(idx, gen)  ((int)(((gen) & IPC_FD_GEN_MASK) << IPC_FD_INDEX_BITS) | (int)(idx))
+// Markiert das Ende einer Hash-Kette bzw. der Freiliste
+#define IPC_NO_SLOT 0xFF
+// Anzahl der Buckets im Namens-Index (Zweierpotenz)
+#define IPC_NAME_BUCKETS 64
+
+// --- IPC-Statistik ---
+
+// 0 schaltet die Statistik komplett ab, die Hooks werden dann zu leeren Makros
+#ifndef IPC_STATS_ENABLE
+#define IPC_STATS_ENABLE 1
+#endif
+
+#if IPC_STATS_ENABLE
+// Anzahl gemerkter Zeitpunkte je Queue. Liegen mehr Nachrichten in der Queue,
+// wird für die älteren keine Latenz gemessen.
+#define IPC_STATS_STAMPS  16
+// Latenz-Histogramm in Dekaden: <10us, <100us, <1ms, <10ms, <100ms, <1s, >=1s
+#define IPC_STATS_BUCKETS 7
+
+// Zeitpunkt einer Nachricht, je nachdem ob Sender oder Empfänger zuerst zählt
+typedef struct {
+	uint32_t seq;                          // Nummer der Nachricht
+	uint32_t us;                           // Zeitpunkt (us, unterste 32 Bit)
+	uint8_t rx;                            // 1 = Empfangszeit, Sender war noch nicht fertig
+} IPCStamp;
+
+// Zähler einer Queue, liegt im PSRAM und wird mit der Queue angelegt
+typedef struct {
+	uint32_t sends;                        // Erfolgreich gesendete Nachrichten
+	uint32_t receives;                     // Empfangene Nachrichten
+	uint32_t timeouts;                     // Senden/Empfangen mit Wartezeit ohne Erfolg
+	uint32_t high_water;                   // Höchster Füllstand (Nachrichten, bei Ringen Bytes)
+	uint32_t enq;                          // Laufende Nummer der nächsten gesendeten Nachricht
+	uint32_t deq;                          // Laufende Nummer der nächsten empfangenen Nachricht
+	IPCStamp stamps[IPC_STATS_STAMPS];     // Zeitpunkte der letzten Nachrichten
+	uint32_t latency_max;                  // Größte gemessene Latenz in us
+	uint64_t latency_sum;                  // Summe der gemessenen Latenzen in us
+	uint32_t hist[IPC_STATS_BUCKETS];      // Latenz-Histogramm
+} IPCStats;
+
+// Zeitpunkt vor dem Einreihen, wird an IPC_STAT_SENT übergeben
+#define IPC_STAT_NOW()                 ((uint32_t)esp_timer_get_time())
+#define IPC_STAT_SENT(entry, n, since) ipc_stat_sent(entry, n, since)
+#define IPC_STAT_RECEIVED(entry)       ipc_stat_received(entry)
+#define IPC_STAT_TIMEOUT(entry)        ipc_stat_timeout(entry)
+#else
+#define IPC_STAT_NOW()                 0
+#define IPC_STAT_SENT(entry, n, since) ((void)(since))
+#define IPC_STAT_RECEIVED(entry)   ((void)0)
+#define IPC_STAT_TIMEOUT(entry)    ((void)0)
+#endif
 
 // Struktur zur Verwaltung einer IPC-Queue
 typedef struct {
-	int fd;                         // File-Descriptor der Queue
+	int fd;                         // File-Descriptor der Queue (-1 = Slot frei)
 	char name[MAX_QUEUE_NAME_LEN];  // Name der Queue
-	QueueHandle_t queue;            // FreeRTOS-Queue-Handle
+	QueueHandle_t queue;            // FreeRTOS-Queue-Handle (FIXED, ZC)
+	MessageBufferHandle_t mbuf;     // Message-Buffer (BUF)
+	IPCRing *ring;                  // Ringpuffer (RING)
+	SemaphoreHandle_t tx_lock;      // Serialisiert die Sender eines Message-Buffers
+	SemaphoreHandle_t rx_lock;      // Serialisiert die Empfänger eines Message-Buffers
+	uint16_t gen;                   // Generation des Slots
+	uint8_t next;                   // Nächster Slot in der Hash-Kette bzw. Freiliste
+	uint8_t type;                   // IPC_QUEUE_FIXED, IPC_QUEUE_ZC, IPC_QUEUE_BUF oder IPC_QUEUE_RING
+#if IPC_STATS_ENABLE
+	IPCStats *stats;                // Zähler der Queue (NULL, falls kein Speicher frei war)
+#endif
 } IPCQueueEntry;
 
 // Array zur Verwaltung der IPC-Queues
 static IPCQueueEntry ipc_queues[MAX_QUEUES];
+// Namens-Index: Kopf der Hash-Kette je Bucket
+static uint8_t ipc_name_index[IPC_NAME_BUCKETS];
+// Erster freier Slot
+static uint8_t ipc_free_head = IPC_NO_SLOT;
+// Schützt Freiliste, Namens-Index und Poll-Tabelle
+static portMUX_TYPE ipc_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Index der Task-Notification, über den IPC-Wartende geweckt werden
+// (setzt CONFIG_FREERTOS_TASK_NOTIFICATION_ARRAY_ENTRIES >= 2 voraus)
+#define IPC_NOTIFY_INDEX 1
+// Maximale Anzahl gleichzeitig in sys_poll wartender Tasks
+#define IPC_POLL_WAITERS 8
+
+// Ein in sys_poll wartender Task und die fds, auf die er wartet
+typedef struct {
+	TaskHandle_t task;
+	const IPCPollFd_t *fds;
+	size_t n;
+} IPCPollWaiter;
+
+static IPCPollWaiter ipc_pollers[IPC_POLL_WAITERS];
+static uint32_t ipc_poll_count = 0;
+
+// --- Publish/Subscribe ---
+
+// Maximale Anzahl gleichzeitig abonnierter Themen und Abonnenten je Thema
+#define MAX_TOPICS      16
+#define MAX_SUBSCRIBERS 8
+
+// Ein Thema mit den Zustellqueues seiner Abonnenten (geschützt durch ipc_lock)
+typedef struct {
+	char name[MAX_QUEUE_NAME_LEN];    // Name des Themas
+	uint8_t count;                    // Anzahl Abonnenten (0 = Eintrag frei)
+	int subs[MAX_SUBSCRIBERS];        // fds der Zustellqueues (-1 = frei)
+	uint32_t drops[MAX_SUBSCRIBERS];  // Verworfene Nachrichten je Abonnent
+	int16_t owner[MAX_SUBSCRIBERS];   // App-Slot des Abonnenten (-1 = keine App)
+} IPCTopic;
+
+static IPCTopic ipc_topics[MAX_TOPICS];
+
+// --- Request/Reply (RPC) ---
+
+// Maximale Anzahl gleichzeitig offener Aufrufe
+#define IPC_RPC_SLOTS 16
+// Aufruf-ID aus Platz und Generation, analog zu den fds der Queues
+#define IPC_RPC_ID(slot, gen) IPC_FD(slot, gen)
+
+// Zustände eines Aufrufplatzes
+#define IPC_RPC_FREE     0  // Unbenutzt
+#define IPC_RPC_PENDING  1  // Anfrage gesendet, Aufrufer wartet
+#define IPC_RPC_REPLYING 2  // Server kopiert gerade die Antwort
+#define IPC_RPC_DONE     3  // Antwort liegt vor
+
+// Ein offener Aufruf (geschützt durch ipc_lock)
+typedef struct {
+	TaskHandle_t caller;  // Wartender Task
+	void *reply;          // Antwortpuffer des Aufrufers
+	size_t reply_len;     // Größe des Antwortpuffers
+	int result;           // Länge der Antwort
+	uint16_t gen;         // Generation, macht veraltete Aufruf-IDs ungültig
+	uint8_t state;        // IPC_RPC_*
+} IPCRpcSlot;
+
+static IPCRpcSlot ipc_rpc_slots[IPC_RPC_SLOTS];
+
+// --- Shared Memory ---
+
+// Referenzen von Tasks, die zu keiner App gehören (z. B. Systemdienste), entspricht
+// dem -1 von app_self()
+#define SHM_OWNER_SYSTEM -1
+
+// Ein benanntes Shared-Memory-Segment im PSRAM
+typedef struct {
+	char name[MAX_QUEUE_NAME_LEN];  // Name des Segments
+	void *mem;                      // Speicher (NULL = Eintrag frei)
+	size_t size;                    // Größe in Byte
+	uint16_t refcnt;                // Summe aller Referenzen
+	uint8_t sys_refs;               // Referenzen von SHM_OWNER_SYSTEM, die der Apps
+	                                // stehen in App_t.shm_refs
+} IPCShm;
+
+static IPCShm ipc_shm[MAX_SHM_SEGMENTS];
+// Mutex statt Spinlock, da beim Öffnen und Schließen Speicher verwaltet wird
+static SemaphoreHandle_t ipc_shm_lock = NULL;
+
+// --- Zero-Copy-Nachrichtenpuffer ---
+
+// Anzahl und Nutzdatengröße der vorab im PSRAM angelegten Pool-Puffer.
+// Größere Anforderungen werden einzeln aus dem PSRAM allokiert.
+#define IPC_BUF_POOL_COUNT 32
+#define IPC_BUF_POOL_SIZE  512
+#define IPC_BUF_MAGIC      0x42435049  // "IPCB"
+
+// Kopf eines referenzgezählten Nachrichtenpuffers, die Nutzdaten folgen direkt dahinter
+typedef struct IPCBuffer {
+	uint32_t magic;                 // Erkennung ungültiger Zeiger
+	uint32_t refcnt;                // Referenzzähler (atomar)
+	uint32_t len;                   // Länge der Nutzdaten
+	uint32_t size;                  // Kapazität der Nutzdaten
+	struct IPCBuffer *next_free;    // Nächster freier Pool-Puffer
+	uint32_t pooled;                // 1 = gehört zum Pool
+	uint8_t data[];                 // Nutzdaten
+} IPCBuffer;
+
+static uint8_t *ipc_buf_pool = NULL;
+static IPCBuffer *ipc_buf_free = NULL;
+static portMUX_TYPE ipc_buf_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Heap-Wrapper für Apps, siehe App-Heap
+static void *app_malloc(size_t size);
+static void *app_calloc(size_t n, size_t size);
+static void *app_realloc(void *ptr, size_t size);
+static void app_free(void *ptr);
 
 const struct esp_elfsym elf_symbols[] = {
+	// Werden vor den libc-Symbolen gesucht und ersetzen diese
+	{ "malloc", app_malloc },
+	{ "calloc", app_calloc },
+	{ "realloc", app_realloc },
+	{ "free", app_free },
 	ESP_ELFSYM_EXPORT(snprintf),
-	ESP_ELFSYM_EXPORT(printf),
-	ESP_ELFSYM_EXPORT(fprintf),
+	{ "printf", app_printf },  // Mit Zählung, die Sperre von stdout gilt systemweit
+	{ "fprintf", app_fprintf },
 	ESP_ELFSYM_EXPORT(sys_led),
 	ESP_ELFSYM_EXPORT(sys_led_mode),
 	ESP_ELFSYM_EXPORT(delay_ms),
@@ -91,396 +455,3138 @@ const struct esp_elfsym elf_symbols[] = {
 	ESP_ELFSYM_EXPORT(sys_closequeue),
 	ESP_ELFSYM_EXPORT(sys_sendmsg),
 	ESP_ELFSYM_EXPORT(sys_recvmsg),
+	ESP_ELFSYM_EXPORT(sys_openqueue_buf),
+	ESP_ELFSYM_EXPORT(sys_recvmsg_len),
+	ESP_ELFSYM_EXPORT(sys_sendmsg_batch),
+	ESP_ELFSYM_EXPORT(sys_recvmsg_batch),
+	ESP_ELFSYM_EXPORT(sys_sendmsg_timeout),
+	ESP_ELFSYM_EXPORT(sys_recvmsg_timeout),
+	ESP_ELFSYM_EXPORT(sys_sendmsg_nb),
+	ESP_ELFSYM_EXPORT(sys_recvmsg_nb),
+	ESP_ELFSYM_EXPORT(sys_poll),
+	ESP_ELFSYM_EXPORT(sys_openqueue_zc),
+	ESP_ELFSYM_EXPORT(sys_msg_alloc),
+	ESP_ELFSYM_EXPORT(sys_msg_release),
+	ESP_ELFSYM_EXPORT(sys_sendmsg_zc),
+	ESP_ELFSYM_EXPORT(sys_recvmsg_zc),
+	ESP_ELFSYM_EXPORT(sys_subscribe),
+	ESP_ELFSYM_EXPORT(sys_unsubscribe),
+	ESP_ELFSYM_EXPORT(sys_publish),
+	ESP_ELFSYM_EXPORT(sys_sub_drops),
+	ESP_ELFSYM_EXPORT(sys_ring_open),
+	ESP_ELFSYM_EXPORT(sys_ring_write),
+	ESP_ELFSYM_EXPORT(sys_ring_read),
+	ESP_ELFSYM_EXPORT(sys_call),
+	ESP_ELFSYM_EXPORT(sys_rpc_recv),
+	ESP_ELFSYM_EXPORT(sys_rpc_reply),
+	ESP_ELFSYM_EXPORT(sys_shm_open),
+	ESP_ELFSYM_EXPORT(sys_shm_close),
+	ESP_ELFSYM_EXPORT(sys_seq_write_begin),
+	ESP_ELFSYM_EXPORT(sys_seq_write_end),
+	ESP_ELFSYM_EXPORT(sys_seq_read_begin),
+	ESP_ELFSYM_EXPORT(sys_seq_read_retry),
 	ESP_ELFSYM_END
 };
 
-// System-Call: Neue Queue mit Namen öffnen
-int sys_openqueue(const char *name) {
-	for (int i = 0; i < MAX_QUEUES; i++) {
-		if (ipc_queues[i].queue == NULL) {
-			ipc_queues[i].queue = xQueueCreate(10, IPC_MSG_MAX_LEN);
-			ipc_queues[i].fd = i;
-			strncpy(ipc_queues[i].name, name, MAX_QUEUE_NAME_LEN - 1);
-			ipc_queues[i].name[MAX_QUEUE_NAME_LEN - 1] = '\0';
-			return ipc_queues[i].fd;
-		}
+// FNV-1a-Hash über den (ggf. abgeschnittenen) Queue-Namen
+static uint32_t ipc_name_hash(const char *name) {
+	uint32_t hash = 2166136261u;
+	for (int i = 0; i < MAX_QUEUE_NAME_LEN && name[i] != '\0'; i++) {
+		hash ^= (uint8_t)name[i];
+		hash *= 16777619u;
 	}
-	return -1;  // Kein Platz mehr für neue Queues
+	return hash & (IPC_NAME_BUCKETS - 1);
 }
 
-// System-Call: Bestehende Queue mit Namen finden
-int sys_findqueue(const char *name) {
+// Initialisiert Freiliste und Namens-Index
+static void ipc_init() {
 	for (int i = 0; i < MAX_QUEUES; i++) {
-		if (ipc_queues[i].queue != NULL && strncmp(ipc_queues[i].name, name, MAX_QUEUE_NAME_LEN) == 0) {
-			//printf("Queue %d %d %s gefunden\n", i, ipc_queues[i].fd, ipc_queues[i].name);
-			return ipc_queues[i].fd;
-		}
+		ipc_queues[i].fd = -1;
+		ipc_queues[i].queue = NULL;
+		ipc_queues[i].name[0] = '\0';
+		ipc_queues[i].next = (i + 1 < MAX_QUEUES) ? i + 1 : IPC_NO_SLOT;
 	}
-	return -1;  // Keine Queue mit diesem Namen gefunden
-}
+	ipc_free_head = 0;
+	memset(ipc_name_index, IPC_NO_SLOT, sizeof(ipc_name_index));
+	ipc_shm_lock = xSemaphoreCreateMutex();
 
-// System-Call: Queue schließen
-int sys_closequeue(int fd) {
-	for (int i = 0; i < MAX_QUEUES; i++) {
-		if (ipc_queues[i].fd == fd) {
-			vQueueDelete(ipc_queues[i].queue);
-			ipc_queues[i].queue = NULL;
-			ipc_queues[i].fd--;
-			ipc_queues[i].name[0] = '\0';
-			return 0;
-		}
+	// Pufferpool für Zero-Copy-Nachrichten anlegen
+	const size_t stride = sizeof(IPCBuffer) + IPC_BUF_POOL_SIZE;
+	ipc_buf_pool = heap_caps_malloc(IPC_BUF_POOL_COUNT * stride, MALLOC_CAP_SPIRAM);
+	if (ipc_buf_pool == NULL) {
+		ESP_LOGW(TAG, "IPC-Pufferpool konnte nicht angelegt werden");
+		return;
+	}
+	for (int i = 0; i < IPC_BUF_POOL_COUNT; i++) {
+		IPCBuffer *buf = (IPCBuffer *)(ipc_buf_pool + i * stride);
+		buf->magic = IPC_BUF_MAGIC;
+		buf->refcnt = 0;
+		buf->size = IPC_BUF_POOL_SIZE;
+		buf->pooled = 1;
+		buf->next_free = ipc_buf_free;
+		ipc_buf_free = buf;
 	}
-	return -1;  // fd nicht gefunden
 }
 
-// System-Call: Nachricht senden
-int sys_sendmsg(int fd, const char *msg, size_t len) {
-	for (int i = 0; i < MAX_QUEUES; i++) {
-		if (ipc_queues[i].fd == fd) {
-			char buffer[IPC_MSG_MAX_LEN];
-			strncpy(buffer, msg, len);
-			buffer[len] = '\0';
-			//printf("Nachricht senden über Queue %d: %s\n", i, buffer);
-			return xQueueSend(ipc_queues[i].queue, buffer, pdMS_TO_TICKS(2000)) == pdTRUE ? 0 : -1;
-		}
+// Liefert den Pufferkopf zu einem Nutzdatenzeiger oder NULL bei ungültigem Zeiger
+static IPCBuffer *ipc_buf_get(void *msg) {
+	if (msg == NULL) {
+		return NULL;
 	}
-	return -1;  // fd ungültig
+	IPCBuffer *buf = (IPCBuffer *)((uint8_t *)msg - offsetof(IPCBuffer, data));
+	if (buf->magic != IPC_BUF_MAGIC || __atomic_load_n(&buf->refcnt, __ATOMIC_ACQUIRE) == 0) {
+		return NULL;
+	}
+	return buf;
 }
 
-// System-Call: Nachricht empfangen
-int sys_recvmsg(int fd, char *buffer, size_t len) {
-	for (int i = 0; i < MAX_QUEUES; i++) {
-		if (ipc_queues[i].fd == fd) {
-			char received[IPC_MSG_MAX_LEN];
-			if (xQueueReceive(ipc_queues[i].queue, received, pdMS_TO_TICKS(2000)) != pdTRUE) {
-				return -1;  // Keine Nachricht verfügbar
-			}
-			strncpy(buffer, received, len);
-			buffer[len - 1] = '\0';
-			//printf("Nachricht empfangen über Queue %d: %s\n", i, buffer);
-			return 0;
+// Allokiert einen Puffer mit Referenzzähler 1 (aus dem Pool, falls er passt)
+static IPCBuffer *ipc_buf_alloc(size_t len) {
+	IPCBuffer *buf = NULL;
+	if (len <= IPC_BUF_POOL_SIZE) {
+		taskENTER_CRITICAL(&ipc_buf_lock);
+		buf = ipc_buf_free;
+		if (buf != NULL) {
+			ipc_buf_free = buf->next_free;
 		}
+		taskEXIT_CRITICAL(&ipc_buf_lock);
 	}
-	return -1;  // fd ungültig
-}
-
-float readGyroX()
-{
-	mpu6500_readGyroskop();
-	return mpu6500_gyro[0];
-}
-
-float readGyroY()
-{
-	mpu6500_readGyroskop();
-	return mpu6500_gyro[1];
-}
-
-float readGyroZ()
-{
-	mpu6500_readGyroskop();
-	return mpu6500_gyro[2];
+	if (buf == NULL) {
+		buf = heap_caps_malloc(sizeof(IPCBuffer) + len, MALLOC_CAP_SPIRAM);
+		if (buf == NULL) {
+			return NULL;
+		}
+		buf->magic = IPC_BUF_MAGIC;
+		buf->size = len;
+		buf->pooled = 0;
+	}
+	buf->len = len;
+	buf->next_free = NULL;
+	__atomic_store_n(&buf->refcnt, 1, __ATOMIC_RELEASE);
+	return buf;
 }
 
-float readAccelX()
-{
-	mpu6500_readGyroskop();
-	return mpu6500_accel[0];
+// Gibt eine Referenz ab und gibt den Puffer frei, wenn es die letzte war
+static void ipc_buf_release(IPCBuffer *buf) {
+	if (__atomic_sub_fetch(&buf->refcnt, 1, __ATOMIC_ACQ_REL) != 0) {
+		return;
+	}
+	if (buf->pooled) {
+		taskENTER_CRITICAL(&ipc_buf_lock);
+		buf->next_free = ipc_buf_free;
+		ipc_buf_free = buf;
+		taskEXIT_CRITICAL(&ipc_buf_lock);
+	} else {
+		buf->magic = 0;
+		heap_caps_free(buf);
+	}
 }
 
-float readAccelY()
-{
-	mpu6500_readGyroskop();
-	return mpu6500_accel[1];
+// Liefert den Eintrag zu einem fd in O(1) oder NULL, wenn der fd ungültig oder veraltet ist
+static IPCQueueEntry *ipc_get(int fd) {
+	if (fd < 0 || (fd & IPC_FD_INDEX_MASK) >= MAX_QUEUES) {
+		return NULL;
+	}
+	IPCQueueEntry *entry = &ipc_queues[fd & IPC_FD_INDEX_MASK];
+	if (entry->fd != fd) {
+		return NULL;
+	}
+	return entry;
 }
 
-float readAccelZ()
-{
-	mpu6500_readGyroskop();
-	return mpu6500_accel[2];
+// Gibt die FreeRTOS-Objekte einer Queue frei
+static void ipc_destroy(IPCQueueEntry *handles) {
+#if IPC_STATS_ENABLE
+	if (handles->stats != NULL) {
+		heap_caps_free(handles->stats);
+		handles->stats = NULL;
+	}
+#endif
+	if (handles->type == IPC_QUEUE_RING) {
+		if (handles->ring != NULL) {
+			heap_caps_free(handles->ring);
+		}
+		return;
+	}
+	if (handles->type == IPC_QUEUE_BUF) {
+		if (handles->mbuf != NULL) {
+			vMessageBufferDelete(handles->mbuf);
+		}
+		if (handles->tx_lock != NULL) {
+			vSemaphoreDelete(handles->tx_lock);
+		}
+		if (handles->rx_lock != NULL) {
+			vSemaphoreDelete(handles->rx_lock);
+		}
+		return;
+	}
+	if (handles->queue == NULL) {
+		return;
+	}
+	// Noch nicht abgeholte Zero-Copy-Puffer freigeben
+	if (handles->type == IPC_QUEUE_ZC) {
+		IPCBuffer *buf;
+		while (xQueueReceive(handles->queue, &buf, 0) == pdTRUE) {
+			ipc_buf_release(buf);
+		}
+	}
+	vQueueDelete(handles->queue);
 }
 
-void printNumber(int number) {
-	printf("%d", number);
-}
+// Trägt eine Queue mit den in handles angelegten FreeRTOS-Objekten in die Tabelle ein
+static int ipc_open(const char *name, IPCQueueEntry *handles) {
+	if ((handles->type == IPC_QUEUE_BUF) ?
+			(handles->mbuf == NULL || handles->tx_lock == NULL || handles->rx_lock == NULL) :
+			(handles->type == IPC_QUEUE_RING) ? (handles->ring == NULL) : (handles->queue == NULL)) {
+		ipc_destroy(handles);
+		return -1;
+	}
+#if IPC_STATS_ENABLE
+	handles->stats = heap_caps_calloc(1, sizeof(IPCStats), MALLOC_CAP_SPIRAM);
+#endif
 
-void printString(const char *string) {
-	printf("%s", string);
-}
+	taskENTER_CRITICAL(&ipc_lock);
+	uint8_t idx = ipc_free_head;
+	if (idx == IPC_NO_SLOT) {
+		taskEXIT_CRITICAL(&ipc_lock);
+		ipc_destroy(handles);
+		return -1;  // Kein Platz mehr für neue Queues
+	}
+	IPCQueueEntry *entry = &ipc_queues[idx];
+	ipc_free_head = entry->next;
 
-void printChar(char c) {
-	printf("%c", c);
-}
+	strncpy(entry->name, name, MAX_QUEUE_NAME_LEN - 1);
+	entry->name[MAX_QUEUE_NAME_LEN - 1] = '\0';
+	entry->type = handles->type;
+	entry->queue = handles->queue;
+	entry->mbuf = handles->mbuf;
+	entry->ring = handles->ring;
+#if IPC_STATS_ENABLE
+	entry->stats = handles->stats;
+#endif
+	entry->tx_lock = handles->tx_lock;
+	entry->rx_lock = handles->rx_lock;
+	entry->fd = IPC_FD(idx, entry->gen);
 
-void printFloat(float f) {
-	printf("%f", f);
+	// In den Namens-Index einhängen, namenlose Queues (Abos) sind nicht auffindbar
+	entry->next = IPC_NO_SLOT;
+	if (entry->name[0] != '\0') {
+		uint32_t bucket = ipc_name_hash(entry->name);
+		entry->next = ipc_name_index[bucket];
+		ipc_name_index[bucket] = idx;
+	}
+	int fd = entry->fd;
+	taskEXIT_CRITICAL(&ipc_lock);
+	return fd;
 }
 
-void printNewLine() {
-	printf("\n");
+// System-Call: Neue Queue mit Namen öffnen
+int sys_openqueue(const char *name) {
+	// Queue außerhalb des kritischen Abschnitts anlegen (allokiert Speicher)
+	IPCQueueEntry handles = {
+		.type = IPC_QUEUE_FIXED,
+		.queue = xQueueCreate(IPC_QUEUE_DEPTH, IPC_MSG_MAX_LEN),
+	};
+	return ipc_open(name, &handles);
 }
 
-void delay_ms(int ms) {
-	vTaskDelay(pdMS_TO_TICKS(ms));
+// System-Call: Neue Zero-Copy-Queue öffnen, die nur Zeiger auf IPCBuffer überträgt
+int sys_openqueue_zc(const char *name) {
+	IPCQueueEntry handles = {
+		.type = IPC_QUEUE_ZC,
+		.queue = xQueueCreate(IPC_QUEUE_DEPTH, sizeof(IPCBuffer *)),
+	};
+	return ipc_open(name, &handles);
 }
 
-void delay(int s) {
-	vTaskDelay(pdMS_TO_TICKS(s * 1000));
+// System-Call: Neue Queue für Nachrichten variabler Länge öffnen. capacity ist die
+// Größe des Puffers in Byte, jede Nachricht belegt zusätzlich IPC_BUF_MSG_OVERHEAD Byte.
+int sys_openqueue_buf(const char *name, size_t capacity) {
+	if (capacity <= IPC_BUF_MSG_OVERHEAD) {
+		return -1;
+	}
+	IPCQueueEntry handles = {
+		.type = IPC_QUEUE_BUF,
+		.mbuf = xMessageBufferCreate(capacity),
+		.tx_lock = xSemaphoreCreateMutex(),
+		.rx_lock = xSemaphoreCreateMutex(),
+	};
+	return ipc_open(name, &handles);
 }
 
-void sys_led(int value) {
-	xSemaphoreTake(SysLedMutex, portMAX_DELAY);
-	gpio_set_level(BLUE_LED_PIN, value);
-	xSemaphoreGive(SysLedMutex);
+// System-Call: Lock-freien Ringpuffer mit mindestens size Byte im internen RAM öffnen.
+// Der erste Task, der schreibt, und der erste, der liest, behalten diese Rolle bis
+// zum Ende ihrer App; Zugriffe anderer Tasks werden abgewiesen.
+int sys_ring_open(const char *name, size_t size) {
+	if (size == 0 || size > 0x10000) {
+		return -1;
+	}
+	size_t capacity = 1;
+	while (capacity < size) {
+		capacity <<= 1;
+	}
+	IPCQueueEntry handles = {
+		.type = IPC_QUEUE_RING,
+		.ring = heap_caps_calloc(1, sizeof(IPCRing) + capacity, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT),
+	};
+	if (handles.ring != NULL) {
+		handles.ring->size = capacity;
+	}
+	return ipc_open(name, &handles);
 }
 
-void sys_led_blinker_task(void *pvParameters) {
-	uint8_t state = 0;
-	while(1) {
-		sys_led(state);
-		state = !state;
-		vTaskDelay(pdMS_TO_TICKS(500));
+// System-Call: Bestehende Queue mit Namen finden
+int sys_findqueue(const char *name) {
+	int fd = -1;
+	taskENTER_CRITICAL(&ipc_lock);
+	for (uint8_t idx = ipc_name_index[ipc_name_hash(name)]; idx != IPC_NO_SLOT; idx = ipc_queues[idx].next) {
+		if (strncmp(ipc_queues[idx].name, name, MAX_QUEUE_NAME_LEN) == 0) {
+			fd = ipc_queues[idx].fd;
+			break;
+		}
 	}
+	taskEXIT_CRITICAL(&ipc_lock);
+	return fd;  // -1: Keine Queue mit diesem Namen gefunden
 }
 
-void sys_led_mode(uint8_t mode) {
-	SysLedMode = mode;
-	if(SysLedMode == SYS_LED_HEARTBEAT) {
-		if(SysLed == NULL) {
-			xTaskCreatePinnedToCore(&sys_led_blinker_task, "sys_led_blinker_task", 1024, NULL, 2, &SysLed, 0);
+// System-Call: Queue schließen
+// Trägt fd aus dem Thema aus, das er abonniert hat. ipc_lock muss gehalten werden.
+// Liefert 1, wenn fd ein Abo war.
+static int ipc_topic_remove(int fd) {
+	for (int t = 0; t < MAX_TOPICS; t++) {
+		if (ipc_topics[t].count == 0) {
+			continue;
 		}
-	}else if(SysLedMode == SYS_LED_USER) {
-		if(SysLed != NULL) {
-			vTaskDelete(SysLed);
-			SysLed = NULL;
+		for (int s = 0; s < MAX_SUBSCRIBERS; s++) {
+			if (ipc_topics[t].subs[s] == fd) {
+				ipc_topics[t].subs[s] = -1;
+				ipc_topics[t].count--;
+				return 1;
+			}
 		}
 	}
+	return 0;
 }
 
-int fsize(FILE *file) {
-	fseek(file, 0, SEEK_END);
-	int size = ftell(file);
-	fseek(file, 0, SEEK_SET);
-	return size;
-}
+int sys_closequeue(int fd) {
+	taskENTER_CRITICAL(&ipc_lock);
+	IPCQueueEntry *entry = ipc_get(fd);
+	if (entry == NULL) {
+		taskEXIT_CRITICAL(&ipc_lock);
+		return -1;  // fd nicht gefunden
+	}
+	uint8_t idx = fd & IPC_FD_INDEX_MASK;
 
-uint16_t getAppsRunning() {
-	return AppCount;
-}
+	// Ein Abo endet mit seiner Zustellqueue, sonst bliebe der fd im Thema stehen
+	ipc_topic_remove(fd);
 
-void close_app(uint8_t current_count) {
-	uint8_t timeout_cnt = 0;
-	// Beende die App
-	if(Apps[current_count].id > -1 && Apps[current_count].stderror > -1) {
-		// Sende Nachricht an die App, dass sie beendet wird
-		sys_sendmsg(Apps[current_count].id, "exit", 4);
-		// Warte auf Bestätigung der App
-		char buffer[IPC_MSG_MAX_LEN];
-		memset(buffer, 0, IPC_MSG_MAX_LEN);
-		while(sys_recvmsg(Apps[current_count].stderror, &buffer, IPC_MSG_MAX_LEN) != 0 && timeout_cnt < 5) {
-			timeout_cnt++;
-			//printf("Timeout: %d\n", timeout_cnt);
-		}
-		printf("App %s: %s\n", Apps[current_count].name, buffer);
-	} else {
-		printf("App %s: Keine Queue vorhanden\n", Apps[current_count].name);
+	// Aus der Hash-Kette entfernen
+	if (entry->name[0] != '\0') {
+		uint8_t *link = &ipc_name_index[ipc_name_hash(entry->name)];
+		while (*link != IPC_NO_SLOT && *link != idx) {
+			link = &ipc_queues[*link].next;
+		}
+		if (*link == idx) {
+			*link = entry->next;
+		}
 	}
-	// Bereinigung und Freigabe von ELF-Ressourcen
-	esp_elf_deinit(&Apps[current_count].elf);
-	
-	// Freigeben des zugewiesenen Speichers für den Code der App
-	heap_caps_free(Apps[current_count].exec_mem);
-	
-	// Markiere die App als 'nicht mehr laufend'
-	Apps[current_count].running = 0;
-	
-	// Logge, dass die App beendet wurde
-	ESP_LOGI(TAG, "App %s beendet", Apps[current_count].name);
-	
-	// Freigabe des Namens-Speichers der App
-	heap_caps_free(Apps[current_count].name);
-	
-	// Schließe die Queues (stdin und stderr)
-	sys_closequeue(Apps[current_count].id);
-	sys_closequeue(Apps[current_count].stderror);
-	
-	// Verringere den Zähler für laufende Apps
-	AppCount--;
-	
-	// Lösche den aktuellen Task (da die App beendet wurde)
-	vTaskDelete(Apps[current_count].AppHandle);
-	Apps[current_count].AppHandle = NULL;
-	Apps[current_count].mem_size = 0;
-	Apps[current_count].exec_mem = NULL;
+
+	IPCQueueEntry handles = *entry;
+	entry->queue = NULL;
+	entry->mbuf = NULL;
+	entry->ring = NULL;
+#if IPC_STATS_ENABLE
+	entry->stats = NULL;
+#endif
+	entry->tx_lock = NULL;
+	entry->rx_lock = NULL;
+	entry->fd = -1;
+	entry->gen = (entry->gen + 1) & IPC_FD_GEN_MASK;
+	entry->name[0] = '\0';
+	entry->next = ipc_free_head;
+	ipc_free_head = idx;
+	taskEXIT_CRITICAL(&ipc_lock);
+
+	ipc_destroy(&handles);
+	return 0;
 }
 
-void start_app() {
-	uint8_t current_count = AppStartCount;
-		
-	//ToDo: App Close function
+#if IPC_STATS_ENABLE
+// Schützt Nummern und Zeitpunkte der Statistik aller Queues
+static portMUX_TYPE ipc_stat_lock = portMUX_INITIALIZER_UNLOCKED;
 
-	// Markiere die App als 'laufend'
-	Apps[current_count].running = 1;
-	
-	// Öffne Queue für stdin (Eingabe)
-	Apps[current_count].id = sys_openqueue(Apps[current_count].name);
-	if (Apps[current_count].id < 0) {
-		ESP_LOGE(TAG, "Fehler beim Öffnen der Eingabe-Queue für %s", Apps[current_count].name);
-		close_app(current_count);
-		return; // Wenn das Öffnen fehlschlägt, abbrechen
+// Trägt eine Latenz ins Histogramm ein, ipc_stat_lock wird gehalten
+static void ipc_stat_latency(IPCStats *st, uint32_t latency) {
+	int bucket = 0;
+	for (uint32_t limit = 10; bucket < IPC_STATS_BUCKETS - 1 && latency >= limit; limit *= 10) {
+		bucket++;
 	}
-	
-	// Öffne Queue für stderr (Fehlerausgabe)
-	char stderr_queue_name[MAX_QUEUE_NAME_LEN];
-	snprintf(stderr_queue_name, sizeof(stderr_queue_name), "%s_stderr", Apps[current_count].name);
-	Apps[current_count].stderror = sys_openqueue(stderr_queue_name);
-	if (Apps[current_count].stderror < 0) {
-		ESP_LOGE(TAG, "Fehler beim Öffnen der stderr-Queue für %s", Apps[current_count].name);
-		sys_closequeue(Apps[current_count].id);  // Schließe die Eingabe-Queue, wenn die Fehler-Queue nicht geöffnet werden konnte
-		close_app(current_count);
-		return;
+	st->hist[bucket]++;
+	st->latency_sum += latency;
+	if (latency > st->latency_max) {
+		st->latency_max = latency;
 	}
-	
-	// Initialisiere die ELF-Datei
-	esp_elf_init(&Apps[current_count].elf);
-		
-	// Relokation der ELF-Datei (zugehörigen Code im Speicher anpassen)
-	esp_elf_relocate(&Apps[current_count].elf, (const uint8_t *)Apps[current_count].exec_mem);
-	
-	// Anforderung der ELF-Datei (Initialisierung des App-Starts)
-	esp_elf_request(&Apps[current_count].elf, 0, 0, NULL);
-	close_app(current_count);
 }
 
-int16_t checkAppRegister(const char *appname)
-{
-	for(uint16_t i = 0; i < MAX_APPS; i++)
-	{
-		//ESP_LOGI(TAG, "Check App %s with Filename %s", Apps[i].name, appname);
-		if(strcmp(Apps[i].name, appname) == 0)
-		{
-			if(Apps[i].running == 1)
-			{
-				return -2;
-			}
-			else
-			{
-				return i;
+// Zählt n gesendete Nachrichten, since ist der Zeitpunkt vor dem Einreihen. Ein
+// wartender Empfänger kann die Nachricht schon geholt haben, bevor der Sender hier
+// ankommt; dann hat er seine Empfangszeit hinterlegt und der Sender misst.
+static void ipc_stat_sent(IPCQueueEntry *entry, uint32_t n, uint32_t since) {
+	IPCStats *st = entry->stats;
+	if (st == NULL) {
+		return;
+	}
+	__atomic_add_fetch(&st->sends, n, __ATOMIC_RELAXED);
+	uint32_t depth;
+	if (entry->type == IPC_QUEUE_RING) {
+		depth = __atomic_load_n(&entry->ring->head, __ATOMIC_RELAXED) - __atomic_load_n(&entry->ring->tail, __ATOMIC_RELAXED);
+	} else {
+		taskENTER_CRITICAL(&ipc_stat_lock);
+		uint32_t seq = st->enq;
+		st->enq += n;
+		for (uint32_t i = (n > IPC_STATS_STAMPS) ? n - IPC_STATS_STAMPS : 0; i < n; i++) {
+			uint32_t msg = seq + i;
+			IPCStamp *stamp = &st->stamps[msg % IPC_STATS_STAMPS];
+			if (stamp->seq == msg && stamp->rx) {
+				ipc_stat_latency(st, stamp->us - since);
+				stamp->rx = 0;
+			} else {
+				stamp->seq = msg;
+				stamp->us = since;
+				stamp->rx = 0;
 			}
 		}
+		depth = st->enq - st->deq;
+		taskEXIT_CRITICAL(&ipc_stat_lock);
+	}
+	if (depth > st->high_water && depth < 0x80000000u) {
+		st->high_water = depth;
 	}
-	return -1;
 }
 
-int16_t findFreeAppSlot()
-{
-	for(uint16_t i = 0; i < MAX_APPS; i++)
-	{
-		if(Apps[i].running == 0)
-		{
-			return i;
-		}
+// Zählt eine empfangene Nachricht und trägt ihre Wartezeit ins Histogramm ein
+static void ipc_stat_received(IPCQueueEntry *entry) {
+	IPCStats *st = entry->stats;
+	if (st == NULL) {
+		return;
 	}
-	return -1;
+	__atomic_add_fetch(&st->receives, 1, __ATOMIC_RELAXED);
+	if (entry->type == IPC_QUEUE_RING) {
+		return;  // Ringe übertragen Bytes, keine einzelnen Nachrichten
+	}
+	uint32_t now = (uint32_t)esp_timer_get_time();
+	taskENTER_CRITICAL(&ipc_stat_lock);
+	uint32_t seq = st->deq++;
+	IPCStamp *stamp = &st->stamps[seq % IPC_STATS_STAMPS];
+	uint32_t behind = st->enq - seq;
+	if (behind == 0 || behind > 0x80000000u) {
+		// Sender ist noch nicht in ipc_stat_sent angekommen
+		stamp->seq = seq;
+		stamp->us = now;
+		stamp->rx = 1;
+	} else if (stamp->seq == seq && !stamp->rx) {
+		ipc_stat_latency(st, now - stamp->us);
+	}
+	taskEXIT_CRITICAL(&ipc_stat_lock);
 }
 
-int registerApp(const char *appname)
+// Zählt einen Sende- oder Empfangsversuch, der trotz Wartezeit erfolglos war
+static void ipc_stat_timeout(IPCQueueEntry *entry) {
+	if (entry->stats != NULL) {
+		__atomic_add_fetch(&entry->stats->timeouts, 1, __ATOMIC_RELAXED);
+	}
+}
+#endif
+
+// Wandelt eine Wartezeit in ms in Ticks um (negativ = unbegrenzt)
+static TickType_t ipc_ticks(int timeout_ms) {
+	return (timeout_ms < 0) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+}
+
+// Weckt alle Tasks, die in sys_poll auf den fd warten
+static void ipc_wake_pollers(int fd) {
+	if (__atomic_load_n(&ipc_poll_count, __ATOMIC_ACQUIRE) == 0) {
+		return;
+	}
+	taskENTER_CRITICAL(&ipc_lock);
+	for (int w = 0; w < IPC_POLL_WAITERS; w++) {
+		IPCPollWaiter *waiter = &ipc_pollers[w];
+		if (waiter->task == NULL) {
+			continue;
+		}
+		for (size_t i = 0; i < waiter->n; i++) {
+			if (waiter->fds[i].fd == fd) {
+				xTaskNotifyGiveIndexed(waiter->task, IPC_NOTIFY_INDEX);
+				break;
+			}
+		}
+	}
+	taskEXIT_CRITICAL(&ipc_lock);
+}
+
+// Trägt einen beendeten Task aus der Liste der Poller aus (aus app_cleanup).
+// fds zeigte auf seinen Stack, ipc_wake_pollers würde sonst darin lesen.
+static void ipc_poll_release_task(TaskHandle_t task) {
+	taskENTER_CRITICAL(&ipc_lock);
+	for (int w = 0; w < IPC_POLL_WAITERS; w++) {
+		if (ipc_pollers[w].task == task) {
+			ipc_pollers[w].task = NULL;
+			ipc_pollers[w].fds = NULL;
+			ipc_pollers[w].n = 0;
+			ipc_poll_count--;
+		}
+	}
+	taskEXIT_CRITICAL(&ipc_lock);
+}
+
+// Prüft, ob eine Queue eine Nachricht zum Abholen bereithält
+static int ipc_entry_readable(IPCQueueEntry *entry) {
+	if (entry->type == IPC_QUEUE_RING) {
+		return __atomic_load_n(&entry->ring->head, __ATOMIC_ACQUIRE) != entry->ring->tail;
+	}
+	if (entry->type == IPC_QUEUE_BUF) {
+		return xMessageBufferIsEmpty(entry->mbuf) == pdFALSE;
+	}
+	return uxQueueMessagesWaiting(entry->queue) > 0;
+}
+
+// Schreibt höchstens len Byte in den Ring, ohne zu blockieren, und liefert die
+// Anzahl geschriebener Bytes. Der erste schreibende Task wird zum Producer, alle
+// anderen werden mit -1 abgewiesen.
+static int ipc_ring_write(IPCRing *ring, const void *data, size_t len) {
+	if (ipc_ring_claim(&ring->producer, xTaskGetCurrentTaskHandle()) != 0) {
+		return -1;
+	}
+	int wake;
+	size_t written = ipc_ring_put(ring, data, len, &wake);
+	TaskHandle_t consumer = __atomic_load_n(&ring->consumer, __ATOMIC_ACQUIRE);
+	if (wake && consumer != NULL) {
+		xTaskNotifyGiveIndexed(consumer, IPC_NOTIFY_INDEX);
+	}
+	return written;
+}
+
+// Liest höchstens len Byte aus dem Ring und wartet bis zu ticks auf Daten.
+// Liefert die Anzahl gelesener Bytes oder -1. Der erste lesende Task wird zum
+// Consumer, alle anderen werden mit -1 abgewiesen.
+static int ipc_ring_read(IPCRing *ring, void *buffer, size_t len, TickType_t ticks) {
+	if (ipc_ring_claim(&ring->consumer, xTaskGetCurrentTaskHandle()) != 0) {
+		return -1;
+	}
+	size_t got = ipc_ring_get(ring, buffer, len);
+	if (got == 0 && ticks > 0) {
+		const TickType_t start = xTaskGetTickCount();
+		while (!ipc_ring_prepare_wait(ring)) {
+			TickType_t wait = portMAX_DELAY;
+			if (ticks != portMAX_DELAY) {
+				TickType_t elapsed = xTaskGetTickCount() - start;
+				if (elapsed >= ticks) {
+					break;
+				}
+				wait = ticks - elapsed;
+			}
+			ulTaskNotifyTakeIndexed(IPC_NOTIFY_INDEX, pdTRUE, wait);
+		}
+		ipc_ring_end_wait(ring);
+		got = ipc_ring_get(ring, buffer, len);
+	}
+	return got > 0 ? (int)got : -1;  // -1: Keine Daten verfügbar
+}
+
+// Gibt die Rollen frei, die ein beendeter Task in Ringen hatte (aus app_cleanup)
+static void ipc_ring_release_task(TaskHandle_t task) {
+	taskENTER_CRITICAL(&ipc_lock);
+	for (int i = 0; i < MAX_QUEUES; i++) {
+		IPCRing *ring = ipc_queues[i].ring;
+		if (ipc_queues[i].fd < 0 || ipc_queues[i].type != IPC_QUEUE_RING || ring == NULL) {
+			continue;
+		}
+		ipc_ring_unclaim(&ring->producer, task);
+		if (__atomic_load_n(&ring->consumer, __ATOMIC_RELAXED) == task) {
+			ipc_ring_end_wait(ring);
+			ipc_ring_unclaim(&ring->consumer, task);
+		}
+	}
+	taskEXIT_CRITICAL(&ipc_lock);
+}
+
+// Schreibt eine Nachricht in einen Message-Buffer (Sender werden serialisiert).
+// tx_lock wird innerhalb von app_syscall_enter/leave gehalten, damit app_stop den
+// Task nicht mit der Sperre löscht.
+static int ipc_mbuf_send(IPCQueueEntry *entry, const void *msg, size_t len, TickType_t ticks) {
+	if (len == 0) {
+		return -1;
+	}
+	const TickType_t start = xTaskGetTickCount();
+	int sc = app_syscall_enter();
+	if (app_syscall_take(sc, entry->tx_lock, ticks) != 0) {
+		app_syscall_leave(sc);
+		return -1;
+	}
+	size_t sent = 0;
+	TickType_t wait = 0;
+	do {
+		sent = xMessageBufferSend(entry->mbuf, msg, len, wait);
+	} while (sent != len && app_syscall_wait(sc, start, ticks, &wait));
+	xSemaphoreGive(entry->tx_lock);
+	app_syscall_leave(sc);
+	return sent == len ? 0 : -1;
+}
+
+// Liest eine Nachricht aus einem Message-Buffer. Ist sie größer als der Puffer des
+// Aufrufers, wird sie trotzdem abgeholt und abgeschnitten, damit sie die Queue nicht blockiert.
+static int ipc_mbuf_receive(IPCQueueEntry *entry, void *buffer, size_t len, TickType_t ticks) {
+	const TickType_t start = xTaskGetTickCount();
+	int sc = app_syscall_enter();
+	if (app_syscall_take(sc, entry->rx_lock, ticks) != 0) {
+		app_syscall_leave(sc);
+		return -1;
+	}
+	int received = 0;
+	TickType_t wait = 0;
+	do {
+		received = xMessageBufferReceive(entry->mbuf, buffer, len, wait);
+	} while (received == 0 && xMessageBufferIsEmpty(entry->mbuf) != pdFALSE &&
+		app_syscall_wait(sc, start, ticks, &wait));
+	if (received == 0) {
+		received = -1;  // Keine Nachricht verfügbar
+		if (xMessageBufferIsEmpty(entry->mbuf) == pdFALSE) {
+			size_t next = xMessageBufferNextLengthBytes(entry->mbuf);
+			uint8_t *tmp = heap_caps_malloc(next, MALLOC_CAP_SPIRAM);
+			if (tmp != NULL) {
+				xMessageBufferReceive(entry->mbuf, tmp, next, 0);
+				memcpy(buffer, tmp, len);
+				heap_caps_free(tmp);
+				received = len;
+			}
+		}
+	}
+	xSemaphoreGive(entry->rx_lock);
+	app_syscall_leave(sc);
+	return received;
+}
+
+// Liest eine Nachricht aus einem Message-Buffer direkt in einen passenden IPCBuffer
+static IPCBuffer *ipc_mbuf_receive_buf(IPCQueueEntry *entry, TickType_t ticks) {
+	IPCBuffer *buf = ipc_buf_alloc(IPC_BUF_POOL_SIZE);
+	if (buf == NULL) {
+		return NULL;
+	}
+	const TickType_t start = xTaskGetTickCount();
+	int sc = app_syscall_enter();
+	if (app_syscall_take(sc, entry->rx_lock, ticks) != 0) {
+		app_syscall_leave(sc);
+		ipc_buf_release(buf);
+		return NULL;
+	}
+	size_t received = 0;
+	TickType_t wait = 0;
+	do {
+		received = xMessageBufferReceive(entry->mbuf, buf->data, buf->size, wait);
+	} while (received == 0 && xMessageBufferIsEmpty(entry->mbuf) != pdFALSE &&
+		app_syscall_wait(sc, start, ticks, &wait));
+	if (received == 0 && xMessageBufferIsEmpty(entry->mbuf) == pdFALSE) {
+		// Nachricht passt nicht in einen Pool-Puffer
+		ipc_buf_release(buf);
+		buf = ipc_buf_alloc(xMessageBufferNextLengthBytes(entry->mbuf));
+		if (buf != NULL) {
+			received = xMessageBufferReceive(entry->mbuf, buf->data, buf->size, 0);
+		}
+	}
+	xSemaphoreGive(entry->rx_lock);
+	app_syscall_leave(sc);
+	if (buf != NULL && received == 0) {
+		ipc_buf_release(buf);
+		return NULL;
+	}
+	if (buf != NULL) {
+		buf->len = received;
+	}
+	return buf;
+}
+
+// Reiht eine Nachricht in eine Queue beliebigen Typs ein
+static int ipc_entry_push(IPCQueueEntry *entry, const void *msg, size_t len, TickType_t ticks) {
+	switch (entry->type) {
+		case IPC_QUEUE_BUF:
+			return ipc_mbuf_send(entry, msg, len, ticks);
+		case IPC_QUEUE_RING:
+			// Ringe blockieren nie, eine Nachricht wird ganz oder gar nicht geschrieben
+			if (len > ipc_ring_space(entry->ring)) {
+				return -1;
+			}
+			return ipc_ring_write(entry->ring, msg, len) == (int)len ? 0 : -1;
+		case IPC_QUEUE_ZC: {
+			// Auf Zero-Copy-Queues wird die Nachricht einmal in einen Puffer kopiert
+			IPCBuffer *buf = ipc_buf_alloc(len);
+			if (buf == NULL) {
+				return -1;
+			}
+			memcpy(buf->data, msg, len);
+			if (xQueueSend(entry->queue, &buf, ticks) != pdTRUE) {
+				ipc_buf_release(buf);
+				return -1;
+			}
+			return 0;
+		}
+		default: {
+			char buffer[IPC_MSG_MAX_LEN];
+			if (len > IPC_MSG_MAX_LEN - 1) {
+				len = IPC_MSG_MAX_LEN - 1;
+			}
+			strncpy(buffer, msg, len);
+			buffer[len] = '\0';
+			return xQueueSend(entry->queue, buffer, ticks) == pdTRUE ? 0 : -1;
+		}
+	}
+}
+
+// Sendet eine Nachricht über eine Queue beliebigen Typs und weckt wartende Poller
+static int ipc_entry_send(IPCQueueEntry *entry, const void *msg, size_t len, TickType_t ticks) {
+	uint32_t since = IPC_STAT_NOW();
+	int ret = ipc_entry_push(entry, msg, len, ticks);
+	if (ret == 0) {
+		IPC_STAT_SENT(entry, 1, since);
+		ipc_wake_pollers(entry->fd);
+	} else if (ticks > 0) {
+		IPC_STAT_TIMEOUT(entry);
+	}
+	return ret;
+}
+
+// Holt höchstens len Byte aus einer Queue beliebigen Typs und liefert die Länge
+static int ipc_entry_pop(IPCQueueEntry *entry, void *buffer, size_t len, TickType_t ticks) {
+	switch (entry->type) {
+		case IPC_QUEUE_BUF:
+			return ipc_mbuf_receive(entry, buffer, len, ticks);
+		case IPC_QUEUE_RING:
+			return ipc_ring_read(entry->ring, buffer, len, ticks);
+		case IPC_QUEUE_ZC: {
+			IPCBuffer *buf;
+			if (xQueueReceive(entry->queue, &buf, ticks) != pdTRUE) {
+				return -1;  // Keine Nachricht verfügbar
+			}
+			size_t n = (buf->len < len) ? buf->len : len;
+			memcpy(buffer, buf->data, n);
+			ipc_buf_release(buf);
+			return n;
+		}
+		default: {
+			char received[IPC_MSG_MAX_LEN];
+			if (xQueueReceive(entry->queue, received, ticks) != pdTRUE) {
+				return -1;  // Keine Nachricht verfügbar
+			}
+			size_t n = strnlen(received, IPC_MSG_MAX_LEN - 1);
+			if (n > len) {
+				n = len;
+			}
+			memcpy(buffer, received, n);
+			return n;
+		}
+	}
+}
+
+// Empfängt höchstens len Byte aus einer Queue beliebigen Typs und liefert die Länge
+static int ipc_entry_recv(IPCQueueEntry *entry, void *buffer, size_t len, TickType_t ticks) {
+	int received = ipc_entry_pop(entry, buffer, len, ticks);
+	if (received >= 0) {
+		IPC_STAT_RECEIVED(entry);
+	} else if (ticks > 0) {
+		IPC_STAT_TIMEOUT(entry);
+	}
+	return received;
+}
+
+// System-Call: Nachricht senden
+int sys_sendmsg(int fd, const char *msg, size_t len) {
+	IPCQueueEntry *entry = ipc_get(fd);
+	if (entry == NULL) {
+		return -1;  // fd ungültig
+	}
+	//printf("Nachricht senden über Queue %d: %.*s\n", fd, (int)len, msg);
+	return ipc_entry_send(entry, msg, len, pdMS_TO_TICKS(IPC_TIMEOUT_MS));
+}
+
+// System-Call: Nachricht als nullterminierten String empfangen
+int sys_recvmsg(int fd, char *buffer, size_t len) {
+	IPCQueueEntry *entry = ipc_get(fd);
+	if (entry == NULL || len == 0) {
+		return -1;  // fd ungültig
+	}
+	int received = ipc_entry_recv(entry, buffer, len - 1, pdMS_TO_TICKS(IPC_TIMEOUT_MS));
+	if (received < 0) {
+		return -1;  // Keine Nachricht verfügbar
+	}
+	buffer[received] = '\0';
+	//printf("Nachricht empfangen über Queue %d: %s\n", fd, buffer);
+	return 0;
+}
+
+// System-Call: Nachricht binär empfangen, liefert die Anzahl empfangener Bytes oder -1
+int sys_recvmsg_len(int fd, void *buffer, size_t len) {
+	IPCQueueEntry *entry = ipc_get(fd);
+	if (entry == NULL) {
+		return -1;  // fd ungültig
+	}
+	return ipc_entry_recv(entry, buffer, len, pdMS_TO_TICKS(IPC_TIMEOUT_MS));
+}
+
+// System-Call: Nachricht mit eigener Wartezeit senden (0 = nicht blockierend, negativ = unbegrenzt)
+int sys_sendmsg_timeout(int fd, const char *msg, size_t len, int timeout_ms) {
+	IPCQueueEntry *entry = ipc_get(fd);
+	if (entry == NULL) {
+		return -1;  // fd ungültig
+	}
+	return ipc_entry_send(entry, msg, len, ipc_ticks(timeout_ms));
+}
+
+// System-Call: Nachricht mit eigener Wartezeit als String empfangen
+int sys_recvmsg_timeout(int fd, char *buffer, size_t len, int timeout_ms) {
+	IPCQueueEntry *entry = ipc_get(fd);
+	if (entry == NULL || len == 0) {
+		return -1;  // fd ungültig
+	}
+	int received = ipc_entry_recv(entry, buffer, len - 1, ipc_ticks(timeout_ms));
+	if (received < 0) {
+		return -1;  // Keine Nachricht verfügbar
+	}
+	buffer[received] = '\0';
+	return 0;
+}
+
+// System-Call: Nachricht senden, ohne auf Platz in der Queue zu warten
+int sys_sendmsg_nb(int fd, const char *msg, size_t len) {
+	return sys_sendmsg_timeout(fd, msg, len, 0);
+}
+
+// System-Call: Nachricht empfangen, ohne zu warten
+int sys_recvmsg_nb(int fd, char *buffer, size_t len) {
+	return sys_recvmsg_timeout(fd, buffer, len, 0);
+}
+
+// Trägt die Bereitschaft aller fds in revents ein und liefert die Anzahl bereiter fds
+static int ipc_poll_scan(IPCPollFd_t fds[], size_t n) {
+	int ready = 0;
+	for (size_t i = 0; i < n; i++) {
+		IPCQueueEntry *entry = ipc_get(fds[i].fd);
+		fds[i].revents = 0;
+		if (entry == NULL) {
+			fds[i].revents = IPC_POLLNVAL;
+		} else if ((fds[i].events & IPC_POLLIN) && ipc_entry_readable(entry)) {
+			fds[i].revents = IPC_POLLIN;
+		}
+		if (fds[i].revents) {
+			ready++;
+		}
+	}
+	return ready;
+}
+
+// System-Call: Wartet, bis mindestens eine der Queues eine Nachricht enthält.
+// Sender wecken wartende Tasks per Task-Notification, sodass die Reaktion
+// innerhalb eines Ticks erfolgt. Liefert die Anzahl bereiter fds, 0 bei Timeout.
+int sys_poll(IPCPollFd_t fds[], size_t n, int timeout_ms) {
+	if (fds == NULL || n == 0) {
+		return -1;
+	}
+	const TickType_t ticks = ipc_ticks(timeout_ms);
+	int ready = ipc_poll_scan(fds, n);
+	if (ready > 0 || ticks == 0) {
+		return ready;
+	}
+
+	// Als Wartender registrieren, erst danach erneut prüfen (sonst geht ein Wecken verloren)
+	ulTaskNotifyTakeIndexed(IPC_NOTIFY_INDEX, pdTRUE, 0);
+	int slot = -1;
+	taskENTER_CRITICAL(&ipc_lock);
+	for (int w = 0; w < IPC_POLL_WAITERS; w++) {
+		if (ipc_pollers[w].task == NULL) {
+			ipc_pollers[w].task = xTaskGetCurrentTaskHandle();
+			ipc_pollers[w].fds = fds;
+			ipc_pollers[w].n = n;
+			ipc_poll_count++;
+			slot = w;
+			break;
+		}
+	}
+	taskEXIT_CRITICAL(&ipc_lock);
+	if (slot < 0) {
+		return -1;  // Zu viele gleichzeitig wartende Tasks
+	}
+
+	const TickType_t start = xTaskGetTickCount();
+	while ((ready = ipc_poll_scan(fds, n)) == 0) {
+		TickType_t wait = portMAX_DELAY;
+		if (ticks != portMAX_DELAY) {
+			TickType_t elapsed = xTaskGetTickCount() - start;
+			if (elapsed >= ticks) {
+				break;
+			}
+			wait = ticks - elapsed;
+		}
+		ulTaskNotifyTakeIndexed(IPC_NOTIFY_INDEX, pdTRUE, wait);
+	}
+
+	taskENTER_CRITICAL(&ipc_lock);
+	ipc_pollers[slot].task = NULL;
+	ipc_pollers[slot].fds = NULL;
+	ipc_pollers[slot].n = 0;
+	ipc_poll_count--;
+	taskEXIT_CRITICAL(&ipc_lock);
+	return ready;
+}
+
+// System-Call: Bis zu len Byte in einen Ring schreiben, ohne zu warten.
+// Liefert die Anzahl geschriebener Bytes (0, wenn der Ring voll ist) oder -1,
+// wenn schon ein anderer Task in den Ring schreibt.
+int sys_ring_write(int fd, const void *data, size_t len) {
+	IPCQueueEntry *entry = ipc_get(fd);
+	if (entry == NULL || entry->type != IPC_QUEUE_RING) {
+		return -1;
+	}
+	int written = ipc_ring_write(entry->ring, data, len);
+	if (written > 0) {
+		IPC_STAT_SENT(entry, 1, 0);  // Ringe messen keine Latenz
+		ipc_wake_pollers(fd);
+	}
+	return written;
+}
+
+// System-Call: Bis zu len Byte aus einem Ring lesen. Ist er leer, wird bis zu
+// timeout_ms gewartet (negativ = unbegrenzt). Liefert die Anzahl gelesener Bytes oder -1.
+int sys_ring_read(int fd, void *buffer, size_t len, int timeout_ms) {
+	IPCQueueEntry *entry = ipc_get(fd);
+	if (entry == NULL || entry->type != IPC_QUEUE_RING) {
+		return -1;
+	}
+	return ipc_entry_recv(entry, buffer, len, ipc_ticks(timeout_ms));
+}
+
+// System-Call: Referenzgezählten Nachrichtenpuffer für len Byte anfordern.
+// Der Aufrufer hält danach eine Referenz.
+void *sys_msg_alloc(size_t len) {
+	IPCBuffer *buf = ipc_buf_alloc(len);
+	return buf ? buf->data : NULL;
+}
+
+// System-Call: Referenz auf einen Nachrichtenpuffer abgeben
+int sys_msg_release(void *msg) {
+	IPCBuffer *buf = ipc_buf_get(msg);
+	if (buf == NULL) {
+		return -1;  // Kein gültiger Puffer
+	}
+	ipc_buf_release(buf);
+	return 0;
+}
+
+// System-Call: Puffer ohne Kopie senden. Bei Erfolg geht die Referenz des
+// Aufrufers an den Empfänger über, bei einem Fehler bleibt sie beim Aufrufer.
+int sys_sendmsg_zc(int fd, void *msg, size_t len) {
+	IPCQueueEntry *entry = ipc_get(fd);
+	IPCBuffer *buf = ipc_buf_get(msg);
+	if (entry == NULL || buf == NULL || len > buf->size) {
+		return -1;
+	}
+	buf->len = len;
+	if (entry->type != IPC_QUEUE_ZC) {
+		// Andere Queue-Typen: Inhalt kopieren und Puffer danach freigeben
+		if (ipc_entry_send(entry, msg, len, pdMS_TO_TICKS(IPC_TIMEOUT_MS)) != 0) {
+			return -1;
+		}
+		ipc_buf_release(buf);
+		return 0;
+	}
+	uint32_t since = IPC_STAT_NOW();
+	if (xQueueSend(entry->queue, &buf, pdMS_TO_TICKS(IPC_TIMEOUT_MS)) != pdTRUE) {
+		IPC_STAT_TIMEOUT(entry);
+		return -1;
+	}
+	IPC_STAT_SENT(entry, 1, since);
+	ipc_wake_pollers(fd);
+	return 0;
+}
+
+// System-Call: Puffer ohne Kopie empfangen. Der Aufrufer muss ihn mit
+// sys_msg_release wieder freigeben. Liefert NULL, wenn keine Nachricht kam.
+void *sys_recvmsg_zc(int fd, size_t *len) {
+	IPCQueueEntry *entry = ipc_get(fd);
+	if (entry == NULL) {
+		return NULL;
+	}
+	IPCBuffer *buf;
+	if (entry->type == IPC_QUEUE_ZC) {
+		if (xQueueReceive(entry->queue, &buf, pdMS_TO_TICKS(IPC_TIMEOUT_MS)) != pdTRUE) {
+			IPC_STAT_TIMEOUT(entry);
+			return NULL;
+		}
+	} else if (entry->type == IPC_QUEUE_BUF) {
+		buf = ipc_mbuf_receive_buf(entry, pdMS_TO_TICKS(IPC_TIMEOUT_MS));
+		if (buf == NULL) {
+			IPC_STAT_TIMEOUT(entry);
+			return NULL;
+		}
+	} else if (entry->type == IPC_QUEUE_RING) {
+		buf = ipc_buf_alloc(IPC_BUF_POOL_SIZE);
+		if (buf == NULL) {
+			return NULL;
+		}
+		int received = ipc_ring_read(entry->ring, buf->data, buf->size, pdMS_TO_TICKS(IPC_TIMEOUT_MS));
+		if (received < 0) {
+			IPC_STAT_TIMEOUT(entry);
+			ipc_buf_release(buf);
+			return NULL;
+		}
+		buf->len = received;
+	} else {
+		// Klassische Queue: Slot direkt in einen neuen Puffer empfangen
+		buf = ipc_buf_alloc(IPC_MSG_MAX_LEN);
+		if (buf == NULL) {
+			return NULL;
+		}
+		if (xQueueReceive(entry->queue, buf->data, pdMS_TO_TICKS(IPC_TIMEOUT_MS)) != pdTRUE) {
+			IPC_STAT_TIMEOUT(entry);
+			ipc_buf_release(buf);
+			return NULL;
+		}
+		buf->data[IPC_MSG_MAX_LEN - 1] = '\0';
+		buf->len = strlen((char *)buf->data);
+	}
+	IPC_STAT_RECEIVED(entry);
+	if (len != NULL) {
+		*len = buf->len;
+	}
+	return buf->data;
+}
+
+// System-Call: Bis zu n Nachrichten mit einem Lookup senden. Alle Nachrichten, die
+// sofort Platz finden, werden bei angehaltenem Scheduler eingereiht, sodass der
+// Empfänger nur einmal pro Block aufgeweckt wird. Liefert die Anzahl gesendeter Nachrichten.
+int sys_sendmsg_batch(int fd, const IPCMsg_t msgs[], size_t n) {
+	IPCQueueEntry *entry = ipc_get(fd);
+	if (entry == NULL || msgs == NULL) {
+		return -1;  // fd ungültig
+	}
+	const TickType_t ticks = pdMS_TO_TICKS(IPC_TIMEOUT_MS);
+	size_t sent = 0;
+
+	if (entry->type == IPC_QUEUE_RING) {
+		// Ringe sind ohnehin lock-frei, der Batch bringt hier nichts
+		while (sent < n && ipc_entry_send(entry, msgs[sent].data, msgs[sent].len, 0) == 0) {
+			sent++;
+		}
+		return sent;
+	}
+
+	while (sent < n) {
+		size_t chunk = (n - sent < IPC_BATCH_CHUNK) ? n - sent : IPC_BATCH_CHUNK;
+		size_t done = 0;
+		IPCBuffer *bufs[IPC_BATCH_CHUNK];
+		int sc = -1;
+
+		// Alles, was Speicher anfordert oder blockiert, vor dem Anhalten des Schedulers erledigen
+		if (entry->type == IPC_QUEUE_ZC) {
+			for (size_t i = 0; i < chunk; i++) {
+				bufs[i] = ipc_buf_alloc(msgs[sent + i].len);
+				if (bufs[i] == NULL) {
+					chunk = i;
+					break;
+				}
+				memcpy(bufs[i]->data, msgs[sent + i].data, msgs[sent + i].len);
+			}
+			if (chunk == 0) {
+				break;
+			}
+		} else if (entry->type == IPC_QUEUE_BUF) {
+			// tx_lock wie in ipc_mbuf_send nur innerhalb von app_syscall_enter/leave
+			sc = app_syscall_enter();
+			if (app_syscall_take(sc, entry->tx_lock, ticks) != 0) {
+				app_syscall_leave(sc);
+				break;
+			}
+		}
+
+		uint32_t since = IPC_STAT_NOW();
+		vTaskSuspendAll();
+		for (; done < chunk; done++) {
+			const IPCMsg_t *msg = &msgs[sent + done];
+			BaseType_t ok;
+			if (entry->type == IPC_QUEUE_ZC) {
+				ok = xQueueSend(entry->queue, &bufs[done], 0);
+			} else if (entry->type == IPC_QUEUE_BUF) {
+				ok = (msg->len > 0 && xMessageBufferSend(entry->mbuf, msg->data, msg->len, 0) == msg->len);
+			} else {
+				char buffer[IPC_MSG_MAX_LEN];
+				size_t len = (msg->len > IPC_MSG_MAX_LEN - 1) ? IPC_MSG_MAX_LEN - 1 : msg->len;
+				strncpy(buffer, msg->data, len);
+				buffer[len] = '\0';
+				ok = xQueueSend(entry->queue, buffer, 0);
+			}
+			if (ok != pdTRUE) {
+				break;
+			}
+		}
+		xTaskResumeAll();
+		if (done > 0) {
+			IPC_STAT_SENT(entry, done, since);
+			ipc_wake_pollers(fd);
+		}
+
+		if (entry->type == IPC_QUEUE_ZC) {
+			for (size_t i = done; i < chunk; i++) {
+				ipc_buf_release(bufs[i]);
+			}
+		} else if (entry->type == IPC_QUEUE_BUF) {
+			xSemaphoreGive(entry->tx_lock);
+			app_syscall_leave(sc);
+		}
+		sent += done;
+
+		if (sent < n && done < chunk) {
+			// Queue voll: auf Platz für die nächste Nachricht warten
+			if (ipc_entry_send(entry, msgs[sent].data, msgs[sent].len, ticks) != 0) {
+				break;
+			}
+			sent++;
+		}
+	}
+	return sent;
+}
+
+// System-Call: Bis zu max Nachrichten empfangen. Gewartet wird nur auf die erste,
+// danach wird abgeholt, was bereits in der Queue liegt. out[i].len gibt die Größe
+// des Empfangspuffers an und enthält danach die Länge der Nachricht.
+int sys_recvmsg_batch(int fd, IPCMsg_t out[], size_t max, int timeout_ms) {
+	IPCQueueEntry *entry = ipc_get(fd);
+	if (entry == NULL || out == NULL) {
+		return -1;  // fd ungültig
+	}
+	size_t received = 0;
+	TickType_t ticks = ipc_ticks(timeout_ms);
+	while (received < max) {
+		int len = ipc_entry_recv(entry, out[received].data, out[received].len, ticks);
+		if (len < 0) {
+			break;
+		}
+		out[received].len = len;
+		received++;
+		ticks = 0;
+	}
+	return received;
+}
+
+// System-Call: Thema abonnieren. Liefert den fd einer eigenen, namenlosen
+// Zero-Copy-Queue, über die das Abo mit sys_recvmsg oder sys_recvmsg_zc gelesen wird.
+int sys_subscribe(const char *topic) {
+	if (topic == NULL || topic[0] == '\0') {
+		return -1;
+	}
+	int fd = sys_openqueue_zc("");
+	if (fd < 0) {
+		return -1;
+	}
+	int16_t owner = app_self();
+
+	taskENTER_CRITICAL(&ipc_lock);
+	IPCTopic *found = NULL;
+	IPCTopic *unused = NULL;
+	for (int t = 0; t < MAX_TOPICS; t++) {
+		if (ipc_topics[t].count == 0) {
+			if (unused == NULL) {
+				unused = &ipc_topics[t];
+			}
+		} else if (strncmp(ipc_topics[t].name, topic, MAX_QUEUE_NAME_LEN - 1) == 0) {
+			found = &ipc_topics[t];
+			break;
+		}
+	}
+	if (found == NULL && unused != NULL) {
+		found = unused;
+		strncpy(found->name, topic, MAX_QUEUE_NAME_LEN - 1);
+		found->name[MAX_QUEUE_NAME_LEN - 1] = '\0';
+		for (int s = 0; s < MAX_SUBSCRIBERS; s++) {
+			found->subs[s] = -1;
+		}
+	}
+	int slot = -1;
+	if (found != NULL) {
+		for (int s = 0; s < MAX_SUBSCRIBERS; s++) {
+			if (found->subs[s] == -1) {
+				found->subs[s] = fd;
+				found->drops[s] = 0;
+				found->owner[s] = owner;
+				found->count++;
+				slot = s;
+				break;
+			}
+		}
+	}
+	taskEXIT_CRITICAL(&ipc_lock);
+
+	if (slot < 0) {
+		sys_closequeue(fd);
+		return -1;  // Zu viele Themen oder Abonnenten
+	}
+	return fd;
+}
+
+// Sucht den Abo-Eintrag zu einem fd, ipc_lock muss gehalten werden
+static IPCTopic *ipc_topic_of(int fd, int *slot) {
+	for (int t = 0; t < MAX_TOPICS; t++) {
+		if (ipc_topics[t].count == 0) {
+			continue;
+		}
+		for (int s = 0; s < MAX_SUBSCRIBERS; s++) {
+			if (ipc_topics[t].subs[s] == fd) {
+				*slot = s;
+				return &ipc_topics[t];
+			}
+		}
+	}
+	return NULL;
+}
+
+// System-Call: Abo beenden und die Zustellqueue schließen
+int sys_unsubscribe(int fd) {
+	taskENTER_CRITICAL(&ipc_lock);
+	int found = ipc_topic_remove(fd);
+	taskEXIT_CRITICAL(&ipc_lock);
+	if (!found) {
+		return -1;  // Kein Abo mit diesem fd
+	}
+	return sys_closequeue(fd);
+}
+
+// Schließt die Zustellqueues aller Abos einer App (aus app_cleanup)
+static void ipc_topic_release_app(int slot) {
+	int fds[MAX_TOPICS * MAX_SUBSCRIBERS];
+	int n = 0;
+	taskENTER_CRITICAL(&ipc_lock);
+	for (int t = 0; t < MAX_TOPICS; t++) {
+		for (int s = 0; ipc_topics[t].count > 0 && s < MAX_SUBSCRIBERS; s++) {
+			if (ipc_topics[t].subs[s] >= 0 && ipc_topics[t].owner[s] == slot) {
+				fds[n++] = ipc_topics[t].subs[s];
+			}
+		}
+	}
+	taskEXIT_CRITICAL(&ipc_lock);
+	while (n-- > 0) {
+		sys_closequeue(fds[n]);
+	}
+}
+
+// System-Call: Anzahl der Nachrichten, die ein Abonnent verpasst hat, weil seine
+// Queue beim Veröffentlichen voll war
+int sys_sub_drops(int fd) {
+	int slot;
+	int drops = -1;
+	taskENTER_CRITICAL(&ipc_lock);
+	IPCTopic *topic = ipc_topic_of(fd, &slot);
+	if (topic != NULL) {
+		drops = topic->drops[slot];
+	}
+	taskEXIT_CRITICAL(&ipc_lock);
+	return drops;
+}
+
+// System-Call: Nachricht an alle Abonnenten eines Themas verteilen. Die Nutzdaten
+// werden einmal in einen Puffer kopiert, jeder Abonnent erhält eine Referenz darauf.
+// Es wird nicht gewartet: ist die Queue eines Abonnenten voll, wird die Nachricht für
+// ihn verworfen und gezählt. Liefert die Anzahl der erreichten Abonnenten.
+int sys_publish(const char *topic, const void *msg, size_t len) {
+	if (topic == NULL || msg == NULL) {
+		return -1;
+	}
+
+	// Abonnenten unter der Sperre kopieren, gesendet wird außerhalb
+	int subs[MAX_SUBSCRIBERS];
+	int n = 0;
+	IPCTopic *entry = NULL;
+	taskENTER_CRITICAL(&ipc_lock);
+	for (int t = 0; t < MAX_TOPICS; t++) {
+		if (ipc_topics[t].count > 0 && strncmp(ipc_topics[t].name, topic, MAX_QUEUE_NAME_LEN - 1) == 0) {
+			entry = &ipc_topics[t];
+			for (int s = 0; s < MAX_SUBSCRIBERS; s++) {
+				if (entry->subs[s] != -1) {
+					subs[n++] = entry->subs[s];
+				}
+			}
+			break;
+		}
+	}
+	taskEXIT_CRITICAL(&ipc_lock);
+	if (n == 0) {
+		return 0;  // Niemand hat das Thema abonniert
+	}
+
+	IPCBuffer *buf = ipc_buf_alloc(len);
+	if (buf == NULL) {
+		return -1;
+	}
+	memcpy(buf->data, msg, len);
+
+	int delivered = 0;
+	uint32_t since = IPC_STAT_NOW();
+	for (int i = 0; i < n; i++) {
+		IPCQueueEntry *queue = ipc_get(subs[i]);
+		if (queue != NULL) {
+			__atomic_add_fetch(&buf->refcnt, 1, __ATOMIC_RELAXED);
+			if (xQueueSend(queue->queue, &buf, 0) == pdTRUE) {
+				IPC_STAT_SENT(queue, 1, since);
+				ipc_wake_pollers(subs[i]);
+				delivered++;
+				continue;
+			}
+			// Eigene Referenz wird unten abgegeben, der Zähler erreicht hier nicht 0
+			__atomic_sub_fetch(&buf->refcnt, 1, __ATOMIC_RELAXED);
+		}
+		int slot;
+		taskENTER_CRITICAL(&ipc_lock);
+		IPCTopic *owner = ipc_topic_of(subs[i], &slot);
+		if (owner != NULL) {
+			owner->drops[slot]++;
+		}
+		taskEXIT_CRITICAL(&ipc_lock);
+	}
+	ipc_buf_release(buf);
+	return delivered;
+}
+
+// --- Request/Reply (RPC) ---
+
+// Gibt einen Aufrufplatz frei, eine verspätete Antwort erkennt der Server an der
+// neuen Generation. ipc_lock muss gehalten werden.
+static void ipc_rpc_free(IPCRpcSlot *s) {
+	s->state = IPC_RPC_FREE;
+	s->caller = NULL;
+	s->reply = NULL;
+	s->gen = (s->gen + 1) & IPC_FD_GEN_MASK;
+}
+
+// System-Call: Anfrage an den Dienst hinter fd senden und auf die Antwort warten.
+// Die Antwort wird direkt vom Server in reply kopiert, der Aufrufer wird per
+// Task-Notification geweckt. Liefert die Länge der Antwort oder -1 bei Timeout.
+int sys_call(int fd, const void *req, size_t req_len, void *reply, size_t reply_len, int timeout_ms) {
+	IPCQueueEntry *entry = ipc_get(fd);
+	if (entry == NULL || entry->type == IPC_QUEUE_FIXED || entry->type == IPC_QUEUE_RING) {
+		return -1;  // Nur binärfeste Queues können den Rahmen transportieren
+	}
+	const TickType_t ticks = ipc_ticks(timeout_ms);
+
+	// Aufrufplatz reservieren
+	int slot = -1;
+	int call_id = -1;
+	taskENTER_CRITICAL(&ipc_lock);
+	for (int i = 0; i < IPC_RPC_SLOTS; i++) {
+		IPCRpcSlot *s = &ipc_rpc_slots[i];
+		if (s->state == IPC_RPC_FREE) {
+			s->state = IPC_RPC_PENDING;
+			s->caller = xTaskGetCurrentTaskHandle();
+			s->reply = reply;
+			s->reply_len = reply_len;
+			s->result = -1;
+			slot = i;
+			call_id = IPC_RPC_ID(i, s->gen);
+			break;
+		}
+	}
+	taskEXIT_CRITICAL(&ipc_lock);
+	if (slot < 0) {
+		return -1;  // Zu viele offene Aufrufe
+	}
+	IPCRpcSlot *s = &ipc_rpc_slots[slot];
+
+	// Rahmen aus Aufruf-ID und Anfrage senden
+	int ret = -1;
+	IPCBuffer *buf = ipc_buf_alloc(sizeof(int) + req_len);
+	if (buf != NULL) {
+		memcpy(buf->data, &call_id, sizeof(int));
+		memcpy(buf->data + sizeof(int), req, req_len);
+		ulTaskNotifyTakeIndexed(IPC_NOTIFY_INDEX, pdTRUE, 0);
+		ret = ipc_entry_send(entry, buf->data, buf->len, ticks);
+		ipc_buf_release(buf);
+	}
+
+	// Auf die Antwort warten
+	const TickType_t start = xTaskGetTickCount();
+	int released = 0;
+	while (ret == 0) {
+		TickType_t wait = portMAX_DELAY;
+		taskENTER_CRITICAL(&ipc_lock);
+		uint8_t state = s->state;
+		if (state == IPC_RPC_PENDING && ticks != portMAX_DELAY) {
+			TickType_t elapsed = xTaskGetTickCount() - start;
+			if (elapsed >= ticks) {
+				// Timeout: Platz in derselben Sperre freigeben, damit der Server
+				// nicht mehr mit dem Kopieren beginnen kann
+				ipc_rpc_free(s);
+				released = 1;
+				ret = -1;
+			} else {
+				wait = ticks - elapsed;
+			}
+		}
+		taskEXIT_CRITICAL(&ipc_lock);
+		if (state == IPC_RPC_DONE || ret != 0) {
+			break;
+		}
+		// Während der Server kopiert (IPC_RPC_REPLYING) wird ohne Timeout gewartet,
+		// da reply bis dahin gültig bleiben muss
+		ulTaskNotifyTakeIndexed(IPC_NOTIFY_INDEX, pdTRUE, wait);
+	}
+
+	if (released) {
+		return -1;
+	}
+	taskENTER_CRITICAL(&ipc_lock);
+	int result = s->result;
+	ipc_rpc_free(s);
+	taskEXIT_CRITICAL(&ipc_lock);
+	return (ret == 0) ? result : -1;
+}
+
+// System-Call: Nächste Anfrage an einen Dienst empfangen. call_id muss an
+// sys_rpc_reply übergeben werden. Längere Anfragen werden auf len Byte
+// abgeschnitten. Liefert die Länge der übernommenen Anfrage oder -1.
+int sys_rpc_recv(int fd, void *req, size_t len, int *call_id, int timeout_ms) {
+	IPCQueueEntry *entry = ipc_get(fd);
+	if (entry == NULL || call_id == NULL) {
+		return -1;
+	}
+	IPCBuffer *buf = ipc_buf_alloc(sizeof(int) + len);
+	if (buf == NULL) {
+		return -1;
+	}
+	// Pool-Puffer sind größer als angefordert, empfangen wird nur, was in req passt
+	int received = ipc_entry_recv(entry, buf->data, sizeof(int) + len, ipc_ticks(timeout_ms));
+	if (received < (int)sizeof(int)) {
+		ipc_buf_release(buf);
+		return -1;  // Keine oder keine gültige Anfrage
+	}
+	memcpy(call_id, buf->data, sizeof(int));
+	received -= sizeof(int);
+	memcpy(req, buf->data + sizeof(int), received);
+	ipc_buf_release(buf);
+	return received;
+}
+
+// System-Call: Antwort auf eine mit sys_rpc_recv empfangene Anfrage senden.
+// Liefert -1, wenn der Aufrufer nicht mehr wartet.
+int sys_rpc_reply(int call_id, const void *reply, size_t len) {
+	int slot = call_id & IPC_FD_INDEX_MASK;
+	if (call_id < 0 || slot >= IPC_RPC_SLOTS) {
+		return -1;
+	}
+	IPCRpcSlot *s = &ipc_rpc_slots[slot];
+
+	taskENTER_CRITICAL(&ipc_lock);
+	if (s->state != IPC_RPC_PENDING || IPC_RPC_ID(slot, s->gen) != call_id) {
+		taskEXIT_CRITICAL(&ipc_lock);
+		return -1;  // Aufruf abgelaufen oder unbekannt
+	}
+	s->state = IPC_RPC_REPLYING;
+	taskEXIT_CRITICAL(&ipc_lock);
+
+	// Kopieren außerhalb der Sperre, der Aufrufer gibt den Platz solange nicht frei
+	if (len > s->reply_len) {
+		len = s->reply_len;
+	}
+	if (len > 0) {
+		memcpy(s->reply, reply, len);
+	}
+
+	taskENTER_CRITICAL(&ipc_lock);
+	s->result = len;
+	s->state = IPC_RPC_DONE;
+	TaskHandle_t caller = s->caller;
+	taskEXIT_CRITICAL(&ipc_lock);
+	xTaskNotifyGiveIndexed(caller, IPC_NOTIFY_INDEX);
+	return 0;
+}
+
+// Bricht die offenen Aufrufe eines beendeten Tasks ab (aus app_cleanup). reply
+// lag auf seinem Stack, eine spätere Antwort wird an der neuen Generation
+// abgewiesen. Kopiert ein Server gerade, wird das Ende der Kopie abgewartet.
+static void ipc_rpc_release_task(TaskHandle_t task) {
+	for (int i = 0; i < IPC_RPC_SLOTS; i++) {
+		IPCRpcSlot *s = &ipc_rpc_slots[i];
+		int copying;
+		do {
+			copying = 0;
+			taskENTER_CRITICAL(&ipc_lock);
+			if (s->caller == task && s->state == IPC_RPC_REPLYING) {
+				copying = 1;
+			} else if (s->caller == task && s->state != IPC_RPC_FREE) {
+				ipc_rpc_free(s);
+			}
+			taskEXIT_CRITICAL(&ipc_lock);
+			if (copying) {
+				vTaskDelay(1);
+			}
+		} while (copying);
+	}
+}
+
+// --- Shared Memory ---
+
+// Referenzzähler von owner auf das Segment seg
+static uint8_t *ipc_shm_refs(IPCShm *seg, int owner) {
+	if (owner == SHM_OWNER_SYSTEM) {
+		return &seg->sys_refs;
+	}
+	return &APP(owner)->shm_refs[seg - ipc_shm];
+}
+
+// System-Call: Benanntes Shared-Memory-Segment öffnen. Existiert es noch nicht, wird
+// es mit size Byte im PSRAM angelegt und mit 0 gefüllt. Liefert die Adresse oder NULL.
+void *sys_shm_open(const char *name, size_t size) {
+	if (name == NULL || name[0] == '\0' || size == 0 || ipc_shm_lock == NULL) {
+		return NULL;
+	}
+	int owner = app_self();  // -1 = SHM_OWNER_SYSTEM
+	void *mem = NULL;
+
+	int sc = app_syscall_enter();
+	xSemaphoreTake(ipc_shm_lock, portMAX_DELAY);
+	IPCShm *seg = NULL;
+	IPCShm *unused = NULL;
+	for (int i = 0; i < MAX_SHM_SEGMENTS; i++) {
+		if (ipc_shm[i].mem == NULL) {
+			if (unused == NULL) {
+				unused = &ipc_shm[i];
+			}
+		} else if (strncmp(ipc_shm[i].name, name, MAX_QUEUE_NAME_LEN - 1) == 0) {
+			seg = &ipc_shm[i];
+			break;
+		}
+	}
+	if (seg == NULL && unused != NULL) {
+		unused->mem = heap_caps_calloc(1, size, MALLOC_CAP_SPIRAM);
+		if (unused->mem != NULL) {
+			seg = unused;
+			strncpy(seg->name, name, MAX_QUEUE_NAME_LEN - 1);
+			seg->name[MAX_QUEUE_NAME_LEN - 1] = '\0';
+			seg->size = size;
+			seg->refcnt = 0;
+			seg->sys_refs = 0;
+		}
+	}
+	// Ein bestehendes Segment muss mindestens so groß sein wie angefordert
+	if (seg != NULL && size <= seg->size) {
+		(*ipc_shm_refs(seg, owner))++;
+		seg->refcnt++;
+		mem = seg->mem;
+	}
+	xSemaphoreGive(ipc_shm_lock);
+	app_syscall_leave(sc);
+	return mem;
+}
+
+// Gibt eine Referenz von owner ab und löscht das Segment nach der letzten.
+// ipc_shm_lock muss gehalten werden.
+static void ipc_shm_unref(IPCShm *seg, int owner) {
+	(*ipc_shm_refs(seg, owner))--;
+	seg->refcnt--;
+	if (seg->refcnt == 0) {
+		heap_caps_free(seg->mem);
+		seg->mem = NULL;
+		seg->size = 0;
+		seg->name[0] = '\0';
+	}
+}
+
+// System-Call: Shared-Memory-Segment schließen
+int sys_shm_close(void *mem) {
+	if (mem == NULL || ipc_shm_lock == NULL) {
+		return -1;
+	}
+	int owner = app_self();  // -1 = SHM_OWNER_SYSTEM
+	int ret = -1;
+	int sc = app_syscall_enter();
+	xSemaphoreTake(ipc_shm_lock, portMAX_DELAY);
+	for (int i = 0; i < MAX_SHM_SEGMENTS; i++) {
+		if (ipc_shm[i].mem == mem) {
+			if (*ipc_shm_refs(&ipc_shm[i], owner) > 0) {
+				ipc_shm_unref(&ipc_shm[i], owner);
+				ret = 0;
+			}
+			break;
+		}
+	}
+	xSemaphoreGive(ipc_shm_lock);
+	app_syscall_leave(sc);
+	return ret;  // -1: Segment unbekannt oder nicht von diesem Task geöffnet
+}
+
+// Gibt alle Segmente frei, die eine App noch geöffnet hat (aus app_cleanup)
+static void ipc_shm_release_app(int slot) {
+	if (ipc_shm_lock == NULL) {
+		return;
+	}
+	xSemaphoreTake(ipc_shm_lock, portMAX_DELAY);
+	for (int i = 0; i < MAX_SHM_SEGMENTS; i++) {
+		while (ipc_shm[i].mem != NULL && APP(slot)->shm_refs[i] > 0) {
+			ipc_shm_unref(&ipc_shm[i], slot);
+		}
+	}
+	xSemaphoreGive(ipc_shm_lock);
+}
+
+// Sequenz-Lock für Daten im Shared Memory: ein Schreiber, beliebig viele Leser ohne
+// Mutex. Eine ungerade Sequenznummer bedeutet, dass gerade geschrieben wird.
+// Leser wiederholen ihren Zugriff, solange sys_seq_read_retry 1 liefert:
+//
+//   do {
+//       seq = sys_seq_read_begin(&shm->seq);
+//       memcpy(&copy, &shm->data, sizeof(copy));
+//   } while (sys_seq_read_retry(&shm->seq, seq));
+
+// System-Call: Schreibzugriff beginnen
+void sys_seq_write_begin(uint32_t *seq) {
+	__atomic_store_n(seq, __atomic_load_n(seq, __ATOMIC_RELAXED) + 1, __ATOMIC_RELAXED);
+	// Die ungerade Nummer muss vor den Daten sichtbar werden
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+// System-Call: Schreibzugriff beenden
+void sys_seq_write_end(uint32_t *seq) {
+	__atomic_store_n(seq, __atomic_load_n(seq, __ATOMIC_RELAXED) + 1, __ATOMIC_RELEASE);
+}
+
+// System-Call: Lesezugriff beginnen, wartet, bis kein Schreiber aktiv ist. taskYIELD
+// lässt nur gleich oder höher priorisierte Tasks laufen; wurde ein niedriger
+// priorisierter Schreiber auf demselben Kern mitten im Schreiben verdrängt, käme er
+// nie zurück. Nach SEQ_READ_SPINS Versuchen schläft der Leser deshalb je einen Tick.
+uint32_t sys_seq_read_begin(const uint32_t *seq) {
+	uint32_t start;
+	uint32_t spins = 0;
+	while ((start = __atomic_load_n(seq, __ATOMIC_ACQUIRE)) & 1) {
+		if (++spins < SEQ_READ_SPINS) {
+			taskYIELD();
+		} else {
+			vTaskDelay(1);
+		}
+	}
+	return start;
+}
+
+// System-Call: Liefert 1, wenn während des Lesens geschrieben wurde
+int sys_seq_read_retry(const uint32_t *seq, uint32_t start) {
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	return __atomic_load_n(seq, __ATOMIC_RELAXED) != start;
+}
+
+// Konsolenbefehl: Zeigt die Statistik aller offenen Queues ("ipcstat reset" setzt sie zurück)
+int ipc_stat_cmd(int argc, char **argv) {
+#if IPC_STATS_ENABLE
+	static const char *types[] = {"fixed", "zc", "buf", "ring"};
+	int reset = (argc > 1 && strcmp(argv[1], "reset") == 0);
+	IPCStats *snap = heap_caps_malloc(sizeof(IPCStats), MALLOC_CAP_SPIRAM);
+	if (snap == NULL) {
+		return 1;
+	}
+	printf("%-5s %-15s %-5s %8s %8s %6s %6s %8s %8s  <10us <100us <1ms <10ms <100ms <1s >=1s\n",
+		"fd", "name", "type", "sends", "recvs", "tmo", "hwm", "avg_us", "max_us");
+	for (int i = 0; i < MAX_QUEUES; i++) {
+		char name[MAX_QUEUE_NAME_LEN];
+		int fd;
+		uint8_t type;
+		// Kopie unter der Sperre, damit die Queue nicht währenddessen geschlossen wird
+		taskENTER_CRITICAL(&ipc_lock);
+		fd = ipc_queues[i].fd;
+		if (fd >= 0 && ipc_queues[i].stats != NULL) {
+			memcpy(snap, ipc_queues[i].stats, sizeof(IPCStats));
+			memcpy(name, ipc_queues[i].name, MAX_QUEUE_NAME_LEN);
+			type = ipc_queues[i].type;
+			if (reset) {
+				IPCStats *st = ipc_queues[i].stats;
+				st->sends = st->receives = st->timeouts = 0;
+				st->high_water = st->enq - st->deq;
+				st->latency_max = 0;
+				st->latency_sum = 0;
+				memset(st->hist, 0, sizeof(st->hist));
+			}
+		} else {
+			fd = -1;
+		}
+		taskEXIT_CRITICAL(&ipc_lock);
+		if (fd < 0) {
+			continue;
+		}
+		uint32_t measured = 0;
+		for (int b = 0; b < IPC_STATS_BUCKETS; b++) {
+			measured += snap->hist[b];
+		}
+		printf("%-5d %-15s %-5s %8lu %8lu %6lu %6lu %8lu %8lu ",
+			fd, name[0] ? name : "-", types[type],
+			(unsigned long)snap->sends, (unsigned long)snap->receives,
+			(unsigned long)snap->timeouts, (unsigned long)snap->high_water,
+			(unsigned long)(measured ? snap->latency_sum / measured : 0),
+			(unsigned long)snap->latency_max);
+		for (int b = 0; b < IPC_STATS_BUCKETS; b++) {
+			printf(" %5lu", (unsigned long)snap->hist[b]);
+		}
+		printf("\n");
+	}
+	heap_caps_free(snap);
+#else
+	printf("IPC-Statistik ist deaktiviert (IPC_STATS_ENABLE)\n");
+#endif
+	return 0;
+}
+
+// Parameter für den Empfänger-Task des Batch-Benchmarks
+typedef struct {
+	int fd;
+	int count;
+	int batch;
+	TaskHandle_t done;
+} IPCBenchRx;
+
+static void ipc_bench_rx_task(void *arg) {
+	IPCBenchRx *rx = (IPCBenchRx *)arg;
+	char bufs[IPC_BATCH_CHUNK][IPC_MSG_MAX_LEN];
+	IPCMsg_t msgs[IPC_BATCH_CHUNK];
+	int received = 0;
+	while (received < rx->count) {
+		if (rx->batch > 1) {
+			for (int i = 0; i < rx->batch; i++) {
+				msgs[i].data = bufs[i];
+				msgs[i].len = IPC_MSG_MAX_LEN;
+			}
+			int n = sys_recvmsg_batch(rx->fd, msgs, rx->batch, IPC_TIMEOUT_MS);
+			if (n <= 0) {
+				break;
+			}
+			received += n;
+		} else {
+			if (sys_recvmsg(rx->fd, bufs[0], IPC_MSG_MAX_LEN) != 0) {
+				break;
+			}
+			received++;
+		}
+	}
+	xTaskNotifyGive(rx->done);
+	vTaskDelete(NULL);
+}
+
+// Misst den Durchsatz einzelner Nachrichten gegen Batches von batch Nachrichten.
+// Der Empfänger läuft mit höherer Priorität, damit jedes Aufwecken sichtbar wird.
+static int64_t ipc_bench_throughput(int fd, int count, int batch) {
+	IPCBenchRx rx = {
+		.fd = fd,
+		.count = count,
+		.batch = batch,
+		.done = xTaskGetCurrentTaskHandle(),
+	};
+	IPCMsg_t msgs[IPC_BATCH_CHUNK];
+	for (int i = 0; i < batch; i++) {
+		msgs[i].data = "bench";
+		msgs[i].len = 5;
+	}
+
+	int64_t start = esp_timer_get_time();
+	if (xTaskCreate(ipc_bench_rx_task, "ipcbench_rx", 4096, &rx, uxTaskPriorityGet(NULL) + 1, NULL) != pdPASS) {
+		return -1;
+	}
+	for (int sent = 0; sent < count; ) {
+		if (batch > 1) {
+			int n = sys_sendmsg_batch(fd, msgs, (count - sent < batch) ? count - sent : batch);
+			if (n <= 0) {
+				break;
+			}
+			sent += n;
+		} else {
+			if (sys_sendmsg(fd, "bench", 5) != 0) {
+				break;
+			}
+			sent++;
+		}
+	}
+	ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+	int64_t elapsed = esp_timer_get_time() - start;
+	return elapsed > 0 ? elapsed : 1;
+}
+
+static int ipc_bench_batch(int iterations) {
+	const int batches[] = {1, 4, 8};
+	int fd = sys_openqueue("benchbatch");
+	if (fd < 0) {
+		printf("Queue konnte nicht geöffnet werden\n");
+		return 1;
+	}
+	printf("Batch  msgs/s\n");
+	printf("-------------\n");
+	for (int b = 0; b < sizeof(batches) / sizeof(batches[0]); b++) {
+		int64_t us = ipc_bench_throughput(fd, iterations, batches[b]);
+		if (us < 0) {
+			printf("Empfänger-Task konnte nicht gestartet werden\n");
+			break;
+		}
+		printf("%5d  %6lld\n", batches[b], (int64_t)iterations * 1000000 / us);
+	}
+	sys_closequeue(fd);
+	return 0;
+}
+
+// Kommando "ipcbench": Misst die Kosten von sys_findqueue und sys_sendmsg/sys_recvmsg
+// bei wachsender Anzahl offener Queues. Die Zeiten sollten konstant bleiben.
+// "ipcbench batch" vergleicht den Durchsatz einzelner Nachrichten mit Batches.
+int ipc_bench_cmd(int argc, char **argv) {
+	const int steps[] = {1, 16, 64, 128};
+	int fds[128];
+	int open_count = 0;
+	char name[MAX_QUEUE_NAME_LEN];
+	char msg[IPC_MSG_MAX_LEN];
+
+	int batch_mode = (argc > 1 && strcmp(argv[1], "batch") == 0);
+	if (batch_mode) {
+		argc--;
+		argv++;
+	}
+	const int iterations = (argc > 1) ? atoi(argv[1]) : 1000;
+	if (iterations <= 0) {
+		printf("Usage: ipcbench [batch] [iterations]\n");
+		return 1;
+	}
+	if (batch_mode) {
+		return ipc_bench_batch(iterations);
+	}
+
+	printf("Queues  find [ns]  send+recv [ns]\n");
+	printf("---------------------------------\n");
+	for (int s = 0; s < sizeof(steps) / sizeof(steps[0]); s++) {
+		while (open_count < steps[s]) {
+			snprintf(name, sizeof(name), "bench%d", open_count);
+			fds[open_count] = sys_openqueue(name);
+			if (fds[open_count] < 0) {
+				printf("Keine weiteren Queues verfügbar (%d offen)\n", open_count);
+				goto cleanup;
+			}
+			open_count++;
+		}
+
+		// Gesucht wird immer die zuletzt geöffnete Queue
+		int64_t start = esp_timer_get_time();
+		for (int i = 0; i < iterations; i++) {
+			sys_findqueue(name);
+		}
+		int64_t find_us = esp_timer_get_time() - start;
+
+		int fd = fds[open_count - 1];
+		start = esp_timer_get_time();
+		for (int i = 0; i < iterations; i++) {
+			sys_sendmsg(fd, "bench", 5);
+			sys_recvmsg(fd, msg, sizeof(msg));
+		}
+		int64_t msg_us = esp_timer_get_time() - start;
+
+		printf("%6d  %9lld  %14lld\n", open_count,
+			   find_us * 1000 / iterations, msg_us * 1000 / iterations);
+	}
+
+cleanup:
+	for (int i = 0; i < open_count; i++) {
+		sys_closequeue(fds[i]);
+	}
+	return 0;
+}
+
+// Liest den Sensor unter GyroMutex
+static void read_sensor(void) {
+	int sc = app_syscall_enter();
+	mpu6500_readGyroskop();
+	app_syscall_leave(sc);
+}
+
+float readGyroX()
+{
+	read_sensor();
+	return mpu6500_gyro[0];
+}
+
+float readGyroY()
+{
+	read_sensor();
+	return mpu6500_gyro[1];
+}
+
+float readGyroZ()
+{
+	read_sensor();
+	return mpu6500_gyro[2];
+}
+
+float readAccelX()
+{
+	read_sensor();
+	return mpu6500_accel[0];
+}
+
+float readAccelY()
+{
+	read_sensor();
+	return mpu6500_accel[1];
+}
+
+float readAccelZ()
+{
+	read_sensor();
+	return mpu6500_accel[2];
+}
+
+// printf/fprintf für Apps, siehe app_syscall_enter
+int app_printf(const char *format, ...) {
+	va_list args;
+	va_start(args, format);
+	int sc = app_syscall_enter();
+	int ret = vprintf(format, args);
+	app_syscall_leave(sc);
+	va_end(args);
+	return ret;
+}
+
+int app_fprintf(FILE *stream, const char *format, ...) {
+	va_list args;
+	va_start(args, format);
+	int sc = app_syscall_enter();
+	int ret = vfprintf(stream, format, args);
+	app_syscall_leave(sc);
+	va_end(args);
+	return ret;
+}
+
+void printNumber(int number) {
+	app_printf("%d", number);
+}
+
+void printString(const char *string) {
+	app_printf("%s", string);
+}
+
+void printChar(char c) {
+	app_printf("%c", c);
+}
+
+void printFloat(float f) {
+	app_printf("%f", f);
+}
+
+void printNewLine() {
+	app_printf("\n");
+}
+
+void delay_ms(int ms) {
+	vTaskDelay(pdMS_TO_TICKS(ms));
+}
+
+void delay(int s) {
+	vTaskDelay(pdMS_TO_TICKS(s * 1000));
+}
+
+void sys_led(int value) {
+	int sc = app_syscall_enter();
+	xSemaphoreTake(SysLedMutex, portMAX_DELAY);
+	gpio_set_level(BLUE_LED_PIN, value);
+	xSemaphoreGive(SysLedMutex);
+	app_syscall_leave(sc);
+}
+
+void sys_led_blinker_task(void *pvParameters) {
+	uint8_t state = 0;
+	while(1) {
+		sys_led(state);
+		state = !state;
+		vTaskDelay(pdMS_TO_TICKS(500));
+	}
+}
+
+void sys_led_mode(uint8_t mode) {
+	SysLedMode = mode;
+	if(SysLedMode == SYS_LED_HEARTBEAT) {
+		if(SysLed == NULL) {
+			xTaskCreatePinnedToCore(&sys_led_blinker_task, "sys_led_blinker_task", 1024, NULL, 2, &SysLed, 0);
+		}
+	}else if(SysLedMode == SYS_LED_USER) {
+		if(SysLed != NULL) {
+			vTaskDelete(SysLed);
+			SysLed = NULL;
+		}
+	}
+}
+
+int fsize(FILE *file) {
+	fseek(file, 0, SEEK_END);
+	int size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	return size;
+}
+
+// --- App-Tabelle ---
+
+// Setzt die Heap-Zähler eines Slots zurück
+static void app_heap_reset(App_t *app) {
+	app->allocs = NULL;
+	app->heap_live = 0;
+	app->heap_peak = 0;
+	app->heap_count = 0;
+	app->heap_fails = 0;
+}
+
+// Setzt einen Slot auf den Ausgangszustand
+static void app_slot_reset(App_t *app) {
+	app->AppHandle = NULL;
+	memset(&app->elf, 0, sizeof(esp_elf_t));
+	app->mem_size = 0;
+	app->exec_mem = NULL;
+	app->name = "";
+	app->running = 0;
+	app->id = -1;
+	app->stderror = -1;
+	app->image = NULL;
+	app->xip_slot = -1;
+	app_manifest_default(&app->manifest);
+	memset(app->shm_refs, 0, sizeof(app->shm_refs));
+	app_heap_reset(app);
+	app->lib_count = 0;
+	app->exiting = 0;
+	app->stopping = 0;
+	app->in_syscall = 0;
+	app->kill_pending = 0;
+}
+
+// Gibt die Bibliotheken frei, die eine App verwendet. Erst aufrufen, wenn der Code
+// der App nicht mehr läuft.
+static void app_release_libs(App_t *app) {
+	for (int i = 0; i < app->lib_count; i++) {
+		app_lib_release(app->libs[i]);
+	}
+	app->lib_count = 0;
+}
+
+// Legt einen weiteren Block Slots an und hängt ihn an die Freiliste
+static int app_grow() {
+	if (app_slots >= APP_MAX_SLOTS) {
+		return -1;
+	}
+	App_t *chunk = calloc(APP_CHUNK_SIZE, sizeof(App_t));
+	if (chunk == NULL) {
+		return -1;
+	}
+	for (int i = 0; i < APP_CHUNK_SIZE; i++) {
+		app_slot_reset(&chunk[i]);
+	}
+	taskENTER_CRITICAL(&app_lock);
+	// Zwei Loader können gleichzeitig vergrößern
+	if (app_slots >= APP_MAX_SLOTS) {
+		taskEXIT_CRITICAL(&app_lock);
+		free(chunk);
+		return -1;
+	}
+	app_chunks[app_slots >> APP_CHUNK_SHIFT] = chunk;
+	for (int i = APP_CHUNK_SIZE - 1; i >= 0; i--) {
+		chunk[i].hash_next = app_free_list;
+		app_free_list = app_slots + i;
+	}
+	app_slots += APP_CHUNK_SIZE;
+	taskEXIT_CRITICAL(&app_lock);
+	ESP_LOGI(TAG, "App-Tabelle auf %d Slots vergrößert", app_slots);
+	return 0;
+}
+
+static uint32_t app_name_hash(const char *name) {
+	return ipc_name_hash(name) & (APP_HASH_BUCKETS - 1);
+}
+
+// Sucht einen belegten Slot über den Namensindex. app_lock muss gehalten werden.
+static int16_t app_lookup(const char *appname) {
+	for (int16_t i = app_hash[app_name_hash(appname)]; i >= 0; i = APP(i)->hash_next) {
+		if (strcmp(APP(i)->name, appname) == 0) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+// Nimmt einen reservierten Slot unter seinem Namen in den Index auf. Scheitert, wenn
+// der Name bereits vergeben ist.
+static int app_index_add(uint8_t slot) {
+	App_t *app = APP(slot);
+	uint32_t bucket = app_name_hash(app->name);
+	taskENTER_CRITICAL(&app_lock);
+	if (app_lookup(app->name) >= 0) {
+		taskEXIT_CRITICAL(&app_lock);
+		return -1;
+	}
+	app->gen++;
+	app->hash_next = app_hash[bucket];
+	app_hash[bucket] = slot;
+	app->live_prev = -1;
+	app->live_next = app_live;
+	if (app_live >= 0) {
+		APP(app_live)->live_prev = slot;
+	}
+	app_live = slot;
+	AppCount++;
+	taskEXIT_CRITICAL(&app_lock);
+	return 0;
+}
+
+// Entfernt einen Slot aus dem Index. Der Slot bleibt reserviert, bis app_slot_free
+// aufgerufen wird.
+static void app_index_remove(uint8_t slot) {
+	App_t *app = APP(slot);
+	taskENTER_CRITICAL(&app_lock);
+	int16_t *link = &app_hash[app_name_hash(app->name)];
+	while (*link >= 0 && *link != slot) {
+		link = &APP(*link)->hash_next;
+	}
+	if (*link == slot) {
+		*link = app->hash_next;
+		if (app->live_prev >= 0) {
+			APP(app->live_prev)->live_next = app->live_next;
+		} else {
+			app_live = app->live_next;
+		}
+		if (app->live_next >= 0) {
+			APP(app->live_next)->live_prev = app->live_prev;
+		}
+		AppCount--;
+		app->gen++;
+	}
+	taskEXIT_CRITICAL(&app_lock);
+}
+
+// Vergibt einen freien Slot, bei Bedarf wird die Tabelle vergrößert
+int16_t findFreeAppSlot()
+{
+	if (app_free_list < 0 && app_grow() != 0) {
+		return -1;
+	}
+	taskENTER_CRITICAL(&app_lock);
+	int16_t slot = app_free_list;
+	if (slot >= 0) {
+		app_free_list = APP(slot)->hash_next;
+	}
+	taskEXIT_CRITICAL(&app_lock);
+	return slot;
+}
+
+// Gibt einen Slot zurück an die Freiliste
+static void app_slot_free(uint8_t slot) {
+	taskENTER_CRITICAL(&app_lock);
+	APP(slot)->hash_next = app_free_list;
+	app_free_list = slot;
+	taskEXIT_CRITICAL(&app_lock);
+}
+
+// Liefert die ID einer laufenden App oder -1
+int app_find(const char *appname) {
+	int id = -1;
+	taskENTER_CRITICAL(&app_lock);
+	int16_t slot = app_lookup(appname);
+	if (slot >= 0) {
+		id = APP_ID(slot, APP(slot)->gen);
+	}
+	taskEXIT_CRITICAL(&app_lock);
+	return id;
+}
+
+// Liefert die ID der App, zu der der Task gehört, und kopiert ihren Namen nach name.
+// -1, wenn der Task zu keiner App gehört.
+int app_of_task(TaskHandle_t task, char *name, size_t len) {
+	int id = -1;
+	taskENTER_CRITICAL(&app_lock);
+	for (int16_t i = app_live; i >= 0; i = APP(i)->live_next) {
+		if (APP(i)->AppHandle == task) {
+			id = APP_ID(i, APP(i)->gen);
+			if (name != NULL && len > 0) {
+				strncpy(name, APP(i)->name, len - 1);
+				name[len - 1] = '\0';
+			}
+			break;
+		}
+	}
+	taskEXIT_CRITICAL(&app_lock);
+	return id;
+}
+
+// Liefert den Slot zu einer App-ID oder -1, wenn die ID nicht mehr gültig ist
+static int16_t app_slot_of(int id) {
+	if (id < 0 || APP_ID_SLOT(id) >= app_slots) {
+		return -1;
+	}
+	int16_t slot = APP_ID_SLOT(id);
+	return (APP(slot)->gen & 0x7FFF) == APP_ID_GEN(id) ? slot : -1;
+}
+
+// --- App-Heap ---
+
+// Verbucht eine Größenänderung von old_size auf new_size. Scheitert, wenn die
+// Quote der App dadurch überschritten würde.
+static int app_heap_account(int slot, uint32_t old_size, uint32_t new_size) {
+	App_t *app = APP(slot);
+	int ret = 0;
+	taskENTER_CRITICAL(&app_lock);
+	uint32_t live = app->heap_live - old_size + new_size;
+	if (new_size > old_size && app->manifest.heap_quota != 0 && live > app->manifest.heap_quota) {
+		app->heap_fails++;
+		ret = -1;
+	} else {
+		app->heap_live = live;
+		if (live > app->heap_peak) {
+			app->heap_peak = live;
+		}
+	}
+	taskEXIT_CRITICAL(&app_lock);
+	return ret;
+}
+
+// Alle Blöcke der Wrapper nach Adresse, geschützt durch app_lock
+static AppAlloc *app_heap_hash[1 << APP_HEAP_HASH_BITS];
+
+static AppAlloc **app_heap_bucket(const void *ptr) {
+	uint32_t h = (uint32_t)((uintptr_t)ptr >> 3) * 2654435761u;
+	return &app_heap_hash[h >> (32 - APP_HEAP_HASH_BITS)];
+}
+
+// Trägt einen Block in die Hash-Tabelle und in die Liste seiner App ein
+static void app_heap_link(AppAlloc *block) {
+	AppAlloc **bucket = app_heap_bucket(block + 1);
+	taskENTER_CRITICAL(&app_lock);
+	block->hash_next = *bucket;
+	*bucket = block;
+	block->prev = NULL;
+	block->next = NULL;
+	if (block->slot != APP_HEAP_NO_OWNER) {
+		App_t *app = APP(block->slot);
+		block->next = app->allocs;
+		if (app->allocs != NULL) {
+			app->allocs->prev = block;
+		}
+		app->allocs = block;
+	}
+	taskEXIT_CRITICAL(&app_lock);
+}
+
+// Nimmt einen Block aus der Hash-Tabelle und der Liste seiner App. app_lock muss
+// gehalten werden.
+static void app_heap_unlink_locked(AppAlloc *block) {
+	AppAlloc **link = app_heap_bucket(block + 1);
+	while (*link != block) {
+		link = &(*link)->hash_next;
+	}
+	*link = block->hash_next;
+	if (block->slot == APP_HEAP_NO_OWNER) {
+		return;
+	}
+	if (block->prev != NULL) {
+		block->prev->next = block->next;
+	} else {
+		APP(block->slot)->allocs = block->next;
+	}
+	if (block->next != NULL) {
+		block->next->prev = block->prev;
+	}
+}
+
+// Sucht den Block zu einem Zeiger der Wrapper und trägt ihn aus. Liefert NULL,
+// wenn ptr nicht von app_malloc stammt.
+static AppAlloc *app_heap_take(void *ptr) {
+	taskENTER_CRITICAL(&app_lock);
+	AppAlloc *block = *app_heap_bucket(ptr);
+	while (block != NULL && (void *)(block + 1) != ptr) {
+		block = block->hash_next;
+	}
+	if (block != NULL) {
+		app_heap_unlink_locked(block);
+	}
+	taskEXIT_CRITICAL(&app_lock);
+	return block;
+}
+
+// malloc für Apps: Speicher mit den Heap-Caps der App, gezählt und innerhalb der Quote.
+// Tasks ohne App-Zuordnung (z. B. pthreads einer App) bekommen einen Block ohne Besitzer.
+static void *app_malloc(size_t size) {
+	int slot = app_self();
+	uint32_t caps = slot >= 0 ? APP(slot)->manifest.heap_caps : MALLOC_CAP_DEFAULT;
+	if (size > UINT32_MAX - sizeof(AppAlloc)) {
+		return NULL;
+	}
+	if (slot >= 0 && app_heap_account(slot, 0, size) != 0) {
+		return NULL;
+	}
+	AppAlloc *block = heap_caps_malloc(sizeof(AppAlloc) + size, caps);
+	if (block == NULL) {
+		if (slot >= 0) {
+			app_heap_account(slot, size, 0);
+		}
+		return NULL;
+	}
+	block->size = size;
+	block->slot = slot >= 0 ? slot : APP_HEAP_NO_OWNER;
+	if (slot >= 0) {
+		APP(slot)->heap_count++;
+	}
+	app_heap_link(block);
+	return block + 1;
+}
+
+static void *app_calloc(size_t n, size_t size) {
+	if (size != 0 && n > SIZE_MAX / size) {
+		return NULL;
+	}
+	void *mem = app_malloc(n * size);
+	if (mem != NULL) {
+		memset(mem, 0, n * size);
+	}
+	return mem;
+}
+
+static void app_free(void *ptr) {
+	if (ptr == NULL) {
+		return;
+	}
+	AppAlloc *block = app_heap_take(ptr);
+	if (block == NULL) {
+		// Nicht von app_malloc, z. B. von einer libc-Funktion angelegt
+		free(ptr);
+		return;
+	}
+	if (block->slot != APP_HEAP_NO_OWNER) {
+		app_heap_account(block->slot, block->size, 0);
+	}
+	heap_caps_free(block);
+}
+
+static void *app_realloc(void *ptr, size_t size) {
+	if (ptr == NULL) {
+		return app_malloc(size);
+	}
+	if (size == 0) {
+		app_free(ptr);
+		return NULL;
+	}
+	AppAlloc *block = app_heap_take(ptr);
+	if (block == NULL) {
+		return realloc(ptr, size);
+	}
+	int slot = block->slot == APP_HEAP_NO_OWNER ? -1 : block->slot;
+	uint32_t old_size = block->size;
+	uint32_t caps = slot >= 0 ? APP(slot)->manifest.heap_caps : MALLOC_CAP_DEFAULT;
+	if (size > UINT32_MAX - sizeof(AppAlloc) ||
+			(slot >= 0 && app_heap_account(slot, old_size, size) != 0)) {
+		app_heap_link(block);
+		return NULL;
+	}
+	AppAlloc *moved = heap_caps_realloc(block, sizeof(AppAlloc) + size, caps);
+	if (moved == NULL) {
+		// Der alte Block bleibt gültig
+		app_heap_link(block);
+		if (slot >= 0) {
+			app_heap_account(slot, size, old_size);
+		}
+		return NULL;
+	}
+	moved->size = size;
+	app_heap_link(moved);
+	return moved + 1;
+}
+
+// Gibt alle Blöcke frei, die eine App noch hält (aus app_cleanup)
+static void app_heap_release(uint8_t slot) {
+	App_t *app = APP(slot);
+	uint32_t blocks = 0;
+	uint32_t bytes = 0;
+	for (;;) {
+		taskENTER_CRITICAL(&app_lock);
+		AppAlloc *block = app->allocs;
+		if (block != NULL) {
+			app_heap_unlink_locked(block);
+		}
+		taskEXIT_CRITICAL(&app_lock);
+		if (block == NULL) {
+			break;
+		}
+		blocks++;
+		bytes += block->size;
+		heap_caps_free(block);
+	}
+	app->heap_live = 0;
+	if (blocks > 0) {
+		ESP_LOGW(TAG, "App %s: %lu Blöcke (%lu Bytes) nicht freigegeben", app->name,
+			(unsigned long)blocks, (unsigned long)bytes);
+	}
+}
+
+// Gibt den Heap-Verbrauch aller laufenden Apps aus (für den free-Befehl)
+void print_app_heap() {
+	printf("%-16s %9s %9s %9s %7s %5s\n", "App", "Belegt", "Spitze", "Quote", "Allocs", "Fehl");
+	uint32_t total = 0;
+	taskENTER_CRITICAL(&app_lock);
+	int count = AppCount;
+	taskEXIT_CRITICAL(&app_lock);
+	int *ids = malloc((count > 0 ? count : 1) * sizeof(int));
+	if (ids == NULL) {
+		return;
+	}
+	int n = 0;
+	taskENTER_CRITICAL(&app_lock);
+	for (int16_t i = app_live; i >= 0 && n < count; i = APP(i)->live_next) {
+		ids[n++] = APP_ID(i, APP(i)->gen);
+	}
+	taskEXIT_CRITICAL(&app_lock);
+	while (n-- > 0) {
+		int16_t i = app_slot_of(ids[n]);
+		if (i < 0) {
+			continue;
+		}
+		App_t *app = APP(i);
+		printf("%-16s %9lu %9lu %9lu %7lu %5lu\n", app->name, (unsigned long)app->heap_live,
+			(unsigned long)app->heap_peak, (unsigned long)app->manifest.heap_quota,
+			(unsigned long)app->heap_count, (unsigned long)app->heap_fails);
+		total += app->heap_live;
+	}
+	free(ids);
+	printf("Apps gesamt:      %lu Bytes\n", (unsigned long)total);
+}
+
+uint16_t getAppsRunning() {
+	return AppCount;
+}
+
+// Gibt alle Ressourcen einer App frei und den Slot zurück. Der Task der App darf zu
+// diesem Zeitpunkt keinen App-Code mehr ausführen; gelöscht wird er vom Aufrufer.
+static void app_cleanup(uint8_t current_count) {
+	// Aus dem Namensindex entfernen, solange der Name noch gültig ist
+	app_index_remove(current_count);
+
+	// Bereinigung und Freigabe von ELF-Ressourcen. Images aus dem Cache bleiben
+	// für den nächsten Start im Speicher, installierte Apps im Flash.
+	if (APP(current_count)->xip_slot >= 0) {
+		app_xip_release(APP(current_count)->xip_slot);
+		APP(current_count)->xip_slot = -1;
+		memset(&APP(current_count)->elf, 0, sizeof(esp_elf_t));
+	} else if (APP(current_count)->image != NULL) {
+		app_cache_release(APP(current_count)->image);
+		APP(current_count)->image = NULL;
+		memset(&APP(current_count)->elf, 0, sizeof(esp_elf_t));
+	} else {
+		esp_elf_deinit(&APP(current_count)->elf);
+	}
+	
+	// Freigeben des zugewiesenen Speichers für den Code der App
+	heap_caps_free(APP(current_count)->exec_mem);
+
+	// Bibliotheken abgeben, nach dem letzten Benutzer werden sie entladen
+	app_release_libs(APP(current_count));
+	
+	// Markiere die App als 'nicht mehr laufend'
+	APP(current_count)->running = 0;
+	
+	// Logge, dass die App beendet wurde
+	ESP_LOGI(TAG, "App %s beendet", APP(current_count)->name);
+	
+	// Noch geöffnete Shared-Memory-Segmente und Heap-Blöcke der App freigeben
+	ipc_shm_release_app(current_count);
+	app_heap_release(current_count);
+	// Rollen in Ringen, damit ein neuer Producer oder Consumer übernehmen kann
+	ipc_ring_release_task(APP(current_count)->AppHandle);
+	// Ein in sys_poll getöteter Task bleibt sonst als Poller eingetragen
+	ipc_poll_release_task(APP(current_count)->AppHandle);
+	// Offene RPC-Aufrufe, sonst schreibt ein Server in den freigegebenen Stack
+	ipc_rpc_release_task(APP(current_count)->AppHandle);
+	// Abos der App, sonst belegen sie ihre Plätze im Thema für immer
+	ipc_topic_release_app(current_count);
+
+	// Freigabe des Namens-Speichers der App
+	heap_caps_free(APP(current_count)->name);
+	APP(current_count)->name = "";
+
+	// Schließe die Queues (stdin und stderr)
+	sys_closequeue(APP(current_count)->id);
+	sys_closequeue(APP(current_count)->stderror);
+	APP(current_count)->id = -1;
+	APP(current_count)->stderror = -1;
+
+	// Slot freigeben. Danach darf der Eintrag nicht mehr angefasst werden, da der
+	// Loader ihn sofort neu vergeben kann.
+	APP(current_count)->AppHandle = NULL;
+	APP(current_count)->mem_size = 0;
+	APP(current_count)->exec_mem = NULL;
+	app_slot_free(current_count);
+}
+
+// Lädt und reloziert ein ELF-Image aus mem oder, wenn mem NULL ist, direkt aus der
+// Datei. Mit use_prelink werden die Symboladressen aus der Prelink-Datei übernommen;
+// fehlt sie oder ist sie veraltet, wird sie beim Laden neu aufgezeichnet
+// (APP_PRELINK_RECORD zeichnet immer neu auf). Symbole aus scope sind nur für
+// dieses Image sichtbar (Bibliotheken aus dem Manifest).
+static int app_relocate(esp_elf_t *elf, const char *path, const uint8_t *mem, time_t mtime, long size,
+		const struct esp_elfsym_scope *scope, uint32_t scope_count, int use_prelink, esp_elf_load_stats_t *stats) {
+	esp_elf_prelink_t prelink;
+	int warm = use_prelink && use_prelink != APP_PRELINK_RECORD &&
+			app_prelink_load(path, mtime, size, &prelink) == 0;
+	if (use_prelink && !warm) {
+		app_prelink_record(&prelink);
+	}
+
+	int64_t start = esp_timer_get_time();
+	esp_elf_init(elf);
+	elf->prelink = use_prelink ? &prelink : NULL;
+	elf->scope = scope;
+	elf->scope_count = scope_count;
+	int ret;
+	memset(stats, 0, sizeof(esp_elf_load_stats_t));
+	if (mem != NULL) {
+		ret = esp_elf_relocate(elf, mem);
+		stats->peak_bytes = size;
+		for (int i = 0; i < ELF_SECS; i++) {
+			stats->peak_bytes += elf->sec[i].size;
+		}
+	} else {
+		FILE *file = fopen(path, "rb");
+		if (!file) {
+			ESP_LOGE(TAG, "Datei %s konnte nicht geöffnet werden!", path);
+			ret = -ENOENT;
+		} else {
+			ret = esp_elf_relocate_file(elf, file, stats);
+			fclose(file);
+		}
+	}
+	elf->prelink = NULL;
+	elf->scope = NULL;
+	elf->scope_count = 0;
+	stats->load_us = (uint32_t)(esp_timer_get_time() - start);
+
+	if (use_prelink && !warm && ret == 0) {
+		app_prelink_save(path, mtime, size, &prelink);
+	}
+	if (use_prelink) {
+		app_prelink_free(&prelink);
+	}
+	if (warm && ret != 0 && ret != -ENOMEM) {
+		// Prelink-Datei passt nicht zur ELF-Datei: verwerfen und normal laden
+		app_prelink_discard(path);
+		return app_relocate(elf, path, mem, mtime, size, scope, scope_count, APP_PRELINK_RECORD, stats);
+	}
+	return ret;
+}
+
+// Lädt und reloziert eine App, entweder aus exec_mem oder direkt aus der Datei
+static int app_load(uint8_t current_count, const char *path) {
+	esp_elf_load_stats_t stats;
+	// Nur die Bibliotheken aus dem Manifest, für die die App eine Referenz hält
+	struct esp_elfsym_scope scope[APP_MANIFEST_MAX_LIBS];
+	for (int i = 0; i < APP(current_count)->lib_count; i++) {
+		app_lib_scope(APP(current_count)->libs[i], &scope[i]);
+	}
+	// Adressen aus Bibliotheken ändern sich von Laden zu Laden, dafür gibt es keinen Prelink
+	int ret = app_relocate(&APP(current_count)->elf, path, APP(current_count)->exec_mem,
+			APP(current_count)->file_mtime, APP(current_count)->file_size, scope, APP(current_count)->lib_count,
+			APP(current_count)->lib_count ? 0 : APP_PRELINK_ENABLE, &stats);
+	if (ret == 0) {
+		APP(current_count)->mem_size = stats.peak_bytes;
+		ESP_LOGI(TAG, "App %s in %lu us geladen, Spitzenspeicher %lu Bytes", APP(current_count)->name,
+			(unsigned long)stats.load_us, (unsigned long)stats.peak_bytes);
+	}
+	return ret;
+}
+
+// Konsolenbefehl: Vergleicht die Ladezeit einer App ohne (kalt) und mit Prelink-Datei (warm).
+// Die App wird dabei nur geladen und reloziert, nicht gestartet.
+int app_bench_cmd(int argc, char **argv) {
+	if (argc < 2) {
+		printf("Verwendung: appbench <app> [durchläufe]\n");
+		return 1;
+	}
+	int runs = (argc > 2) ? atoi(argv[2]) : 5;
+	if (runs <= 0) {
+		runs = 5;
+	}
+	char path[128];
+	snprintf(path, sizeof(path), "%s%s%s", APP_PATH, argv[1], APP_EXT);
+	struct stat st;
+	if (stat(path, &st) != 0) {
+		printf("Datei %s nicht gefunden\n", path);
+		return 1;
+	}
+	AppManifest_t manifest;
+	if (app_manifest_load(path, &manifest) >= 0 && manifest.lib_count > 0) {
+		printf("Apps mit Bibliotheken haben keine Prelink-Datei\n");
+		return 1;
+	}
+
+	esp_elf_t elf;
+	esp_elf_load_stats_t stats;
+	// Prelink-Datei sicherstellen, die Zeit dafür zählt nicht
+	if (app_relocate(&elf, path, NULL, st.st_mtime, st.st_size, NULL, 0, 1, &stats) != 0) {
+		printf("%s konnte nicht geladen werden\n", path);
+		return 1;
+	}
+	esp_elf_deinit(&elf);
+
+	uint64_t total[2] = {0, 0};
+	uint32_t peak[2] = {0, 0};
+	for (int i = 0; i < runs; i++) {
+		for (int warm = 0; warm < 2; warm++) {
+			if (app_relocate(&elf, path, NULL, st.st_mtime, st.st_size, NULL, 0, warm, &stats) != 0) {
+				printf("Laden fehlgeschlagen\n");
+				return 1;
+			}
+			esp_elf_deinit(&elf);
+			total[warm] += stats.load_us;
+			if (stats.peak_bytes > peak[warm]) {
+				peak[warm] = stats.peak_bytes;
+			}
+		}
+	}
+	printf("%s, %d Durchläufe:\n", argv[1], runs);
+	printf("  kalt: %8llu us  Spitze %lu Bytes\n", total[0] / runs, (unsigned long)peak[0]);
+	printf("  warm: %8llu us  Spitze %lu Bytes\n", total[1] / runs, (unsigned long)peak[1]);
+	return 0;
+}
+
+// Konsolenbefehl: Installiert eine App in die App-Partition, danach läuft ihr Code
+// direkt aus dem Flash. Ohne Argument werden die installierten Apps aufgelistet.
+int app_install_cmd(int argc, char **argv) {
+	if (argc < 2) {
+		app_xip_print();
+		return 0;
+	}
+	if (strcmp(argv[1], "-r") == 0) {
+		if (argc < 3) {
+			printf("Verwendung: appinstall -r <app>\n");
+			return 1;
+		}
+		int ret = app_xip_remove(argv[2]);
+		if (ret != 0) {
+			printf("%s\n", ret == -2 ? "App läuft noch" : "App ist nicht installiert");
+			return 1;
+		}
+		printf("%s entfernt\n", argv[2]);
+		return 0;
+	}
+	if (checkAppRegister(argv[1]) >= 0) {
+		printf("App %s läuft noch\n", argv[1]);
+		return 1;
+	}
+	char path[128];
+	snprintf(path, sizeof(path), "%s%s%s", APP_PATH, argv[1], APP_EXT);
+	struct stat st;
+	if (stat(path, &st) != 0) {
+		printf("Datei %s nicht gefunden\n", path);
+		return 1;
+	}
+	AppManifest_t manifest;
+	if (app_manifest_load(path, &manifest) >= 0 && manifest.lib_count > 0) {
+		printf("Apps mit Bibliotheken können nicht installiert werden\n");
+		return 1;
+	}
+	int64_t start = esp_timer_get_time();
+	int slot = app_xip_install(argv[1], path, st.st_mtime, st.st_size);
+	if (slot < 0) {
+		printf("Installation fehlgeschlagen (%d)\n", slot);
+		return 1;
+	}
+	printf("%s in Slot %d installiert (%llu us)\n", argv[1], slot, esp_timer_get_time() - start);
+	return 0;
+}
+
+// Wird im Task der App aufgerufen, wenn sie nicht mehr läuft. Wartet gerade ein
+// anderer Task in app_stop, räumt dieser auf und löscht den Task; sonst hat sich
+// die App selbst beendet und räumt hier auf.
+static void app_exit(uint8_t current_count) {
+	App_t *app = APP(current_count);
+	taskENTER_CRITICAL(&app_lock);
+	uint8_t stopping = app->stopping;
+	app->exiting = 1;
+	taskEXIT_CRITICAL(&app_lock);
+	if (stopping) {
+		xEventGroupSetBits(app->events, APP_EVT_EXITED);
+		vTaskSuspend(NULL);
+	}
+	ESP_LOGI(TAG, "App %s hat sich selbst beendet", app->name);
+	app_cleanup(current_count);
+	vTaskDelete(NULL);
+}
+
+void start_app(void *arg) {
+	// Der Slot wird vom Loader als Task-Parameter übergeben
+	uint8_t current_count = (uint8_t)(uintptr_t)arg;
+	// Für die Heap-Wrapper: malloc aus diesem Task gehört der App
+	vTaskSetThreadLocalStoragePointer(NULL, APP_TLS_INDEX, (void *)(uintptr_t)(current_count + 1));
+
+	// Öffne Queue für stdin (Eingabe)
+	APP(current_count)->id = sys_openqueue(APP(current_count)->name);
+	if (APP(current_count)->id < 0) {
+		ESP_LOGE(TAG, "Fehler beim Öffnen der Eingabe-Queue für %s", APP(current_count)->name);
+		app_exit(current_count);
+		return; // Wenn das Öffnen fehlschlägt, abbrechen
+	}
+	
+	// Öffne Queue für stderr (Fehlerausgabe)
+	char stderr_queue_name[MAX_QUEUE_NAME_LEN];
+	snprintf(stderr_queue_name, sizeof(stderr_queue_name), "%s_stderr", APP(current_count)->name);
+	APP(current_count)->stderror = sys_openqueue(stderr_queue_name);
+	if (APP(current_count)->stderror < 0) {
+		ESP_LOGE(TAG, "Fehler beim Öffnen der stderr-Queue für %s", APP(current_count)->name);
+		app_exit(current_count);  // Schließt auch die Eingabe-Queue
+		return;
+	}
+
+	// Anforderung der ELF-Datei (Initialisierung des App-Starts)
+	esp_elf_request(&APP(current_count)->elf, 0, 0, NULL);
+	app_exit(current_count);
+}
+
+// Liefert den Slot einer laufenden App oder -1
+int16_t checkAppRegister(const char *appname)
 {
-	uint8_t skip_search = 0;
-	char filename[128];
+	taskENTER_CRITICAL(&app_lock);
+	int16_t slot = app_lookup(appname);
+	taskEXIT_CRITICAL(&app_lock);
+	return slot;
+}
 
-	//Check if App is already registered
-	int16_t check = checkAppRegister(appname);
-	if(check > -1)
-	{
-		ESP_LOGI(TAG, "App %s bereits registriert, wird neu geladen", appname);
-		AppStartCount = check;
-		skip_search = 1;
+// --- App-Loader ---
+
+// Die Loader-Tasks lesen und relozieren Apps im Hintergrund, damit die Konsole nicht
+// blockiert. Mehrere Loader teilen sich eine Warteschlange: während einer reloziert,
+// kann der nächste schon lesen. Slot und Name werden unter app_lock vergeben.
+#define APP_LOADER_QUEUE_DEPTH 8
+#define APP_LOADER_STACK       6144
+#define APP_LOADER_PRIORITY    4
+#define APP_LOADER_CORE        1  // Kern des ersten Loaders, weitere reihum
+#define APP_LOADER_WORKERS     2
+#define APP_NAME_MAX_LEN       32
+
+// Auftrag an den Loader
+typedef struct {
+	char name[APP_NAME_MAX_LEN];  // Name der App
+	TaskHandle_t notify;          // Wird nach Abschluss benachrichtigt (optional)
+	AppLoadResult_t *result;      // Ergebnis (optional)
+	int64_t queued;               // Zeitpunkt des Auftrags
+} AppLoadRequest;
+
+static QueueHandle_t app_loader_queue = NULL;
+
+// Gibt einen reservierten Slot wieder frei, wenn der Start scheitert
+static void app_loader_abort(uint8_t slot) {
+	if (APP(slot)->xip_slot >= 0) {
+		app_xip_release(APP(slot)->xip_slot);
+		APP(slot)->xip_slot = -1;
+	} else if (APP(slot)->image != NULL) {
+		app_cache_release(APP(slot)->image);
+		APP(slot)->image = NULL;
+	} else {
+		esp_elf_deinit(&APP(slot)->elf);
 	}
-	else if(check == -2)
-	{
+	memset(&APP(slot)->elf, 0, sizeof(esp_elf_t));
+	heap_caps_free(APP(slot)->exec_mem);
+	APP(slot)->exec_mem = NULL;
+	APP(slot)->mem_size = 0;
+	app_release_libs(APP(slot));
+	app_index_remove(slot);
+	heap_caps_free(APP(slot)->name);
+	APP(slot)->name = "";
+	APP(slot)->running = 0;
+	app_slot_free(slot);
+}
+
+// Führt einen Auftrag aus: Slot vergeben, App laden und relozieren, App-Task starten.
+// Liefert 1 bei Erfolg oder einen negativen Fehlercode wie registerApp.
+static int app_loader_run(const AppLoadRequest *req, AppLoadResult_t *res) {
+	const char *appname = req->name;
+	char filename[128];
+	int64_t start = esp_timer_get_time();
+	res->slot = -1;
+	res->id = -1;
+	res->wait_us = (uint32_t)(start - req->queued);
+
+	if (checkAppRegister(appname) >= 0) {
 		ESP_LOGE(TAG, "App %s bereits registriert", appname);
 		return -3;
 	}
+	int16_t slot = findFreeAppSlot();
+	if (slot == -1) {
+		ESP_LOGE(TAG, "Kein freier App Slot gefunden");
+		return -2;
+	}
+	ESP_LOGI(TAG, "App Slot %d ist frei", slot);
 
-	//Search for free App Slot
-	if(skip_search == 0)
-	{
-		AppStartCount = findFreeAppSlot();
-		ESP_LOGI(TAG, "App Slot %d ist frei", AppStartCount);
+	// Das Ereignis-Flag des Slots wird einmal angelegt und bei jeder Vergabe zurückgesetzt
+	if (APP(slot)->events == NULL) {
+		APP(slot)->events = xEventGroupCreate();
+		if (APP(slot)->events == NULL) {
+			app_slot_free(slot);
+			return -2;
+		}
 	}
+	xEventGroupClearBits(APP(slot)->events, APP_EVT_EXITED);
 
-	if(AppStartCount == -1)
-	{
-		ESP_LOGE(TAG, "Kein freier App Slot gefunden");
+	// Slot reservieren, bevor geladen wird
+	char *name = heap_caps_malloc(strlen(appname) + 1, MALLOC_CAP_SPIRAM);
+	if (name == NULL) {
+		ESP_LOGE(TAG, "Kein Speicher für den Namen von %s", appname);
+		app_slot_free(slot);
 		return -2;
 	}
+	strcpy(name, appname);
+	APP(slot)->running = 1;
+	APP(slot)->name = name;
+	app_heap_reset(APP(slot));
+	APP(slot)->lib_count = 0;
+	if (app_index_add(slot) != 0) {
+		heap_caps_free(APP(slot)->name);
+		APP(slot)->name = "";
+		APP(slot)->running = 0;
+		app_slot_free(slot);
+		return -3;
+	}
+	res->slot = slot;
+	res->id = APP_ID(slot, APP(slot)->gen);
 
-	//Load App
-	//Apps[AppStartCount].name = appname;
-	Apps[AppStartCount].name = heap_caps_malloc(strlen(appname) + 1, MALLOC_CAP_SPIRAM);
-	strcpy(Apps[AppStartCount].name, appname);
 	sprintf(filename, "%s%s%s", APP_PATH, appname, APP_EXT);
-	FILE *file = fopen(filename, "rb");
-	if (!file) {
+	struct stat st;
+	if (stat(filename, &st) != 0) {
 		ESP_LOGE(TAG, "Datei %s konnte nicht geöffnet werden!", filename);
+		app_loader_abort(slot);
 		return -1;
 	}
-	Apps[AppStartCount].mem_size = fsize(file);
-	ESP_LOGI(TAG, "%d Bytes an Speicher werden Reserviert", Apps[AppStartCount].mem_size);
-	Apps[AppStartCount].exec_mem = heap_caps_malloc(Apps[AppStartCount].mem_size, MALLOC_CAP_SPIRAM);
-	fread(Apps[AppStartCount].exec_mem, 1, Apps[AppStartCount].mem_size, file);
-	fclose(file);
-	xTaskCreate(start_app, Apps[AppStartCount].name, 4096, NULL, 5, &Apps[AppStartCount].AppHandle);
-	ESP_LOGI(TAG, "App %s registriert", appname);
-	AppCount++;
+	APP(slot)->file_mtime = st.st_mtime;
+	APP(slot)->file_size = st.st_size;
+
+	// Stack, Priorität, Kern und Heap aus dem Manifest, sonst Voreinstellungen
+	if (app_manifest_load(filename, &APP(slot)->manifest) > 0) {
+		ESP_LOGI(TAG, "Manifest für %s: Stack %lu, Prio %d, Kern %d", appname,
+			(unsigned long)APP(slot)->manifest.stack, APP(slot)->manifest.priority, APP(slot)->manifest.core);
+	}
+
+	// Bibliotheken vor der App laden, damit ihre Symbole beim Relozieren gefunden werden
+	for (int i = 0; i < APP(slot)->manifest.lib_count; i++) {
+		int lib = app_lib_acquire(APP(slot)->manifest.libs[i]);
+		if (lib < 0) {
+			ESP_LOGE(TAG, "Bibliothek %s für %s fehlt", APP(slot)->manifest.libs[i], appname);
+			app_loader_abort(slot);
+			return -6;
+		}
+		APP(slot)->libs[APP(slot)->lib_count++] = lib;
+	}
+
+	// Fest installierte App? Dann läuft der Code direkt aus dem Flash und nur die
+	// Daten werden in den RAM kopiert.
+	// Unveränderte Datei bereits reloziert im Cache? Dann entfällt das Lesen komplett.
+	// Apps mit Bibliotheken werden weder installiert noch zwischengespeichert, da die
+	// Adressen der Bibliotheken nach dem Entladen beim nächsten Laden andere sein können.
+	APP(slot)->xip_slot = APP(slot)->lib_count ? -1 : app_xip_get(appname, st.st_mtime, st.st_size, &APP(slot)->elf);
+	APP(slot)->image = (APP(slot)->lib_count || APP(slot)->xip_slot >= 0) ? NULL :
+		app_cache_get(filename, st.st_mtime, st.st_size);
+	if (APP(slot)->xip_slot >= 0) {
+		ESP_LOGI(TAG, "App %s läuft aus dem Flash (Slot %d)", appname, APP(slot)->xip_slot);
+		APP(slot)->mem_size = 0;
+		APP(slot)->exec_mem = NULL;
+	} else if (APP(slot)->image != NULL) {
+		ESP_LOGI(TAG, "App %s wird aus dem Cache gestartet", appname);
+		APP(slot)->mem_size = 0;
+		APP(slot)->exec_mem = NULL;
+		// .data/.bss sind bereits zurückgesetzt
+		APP(slot)->elf = APP(slot)->image->elf;
+	} else {
+		APP(slot)->exec_mem = NULL;
+		if (!APP_LOAD_STREAM) {
+			FILE *file = fopen(filename, "rb");
+			if (!file) {
+				ESP_LOGE(TAG, "Datei %s konnte nicht geöffnet werden!", filename);
+				app_loader_abort(slot);
+				return -1;
+			}
+			APP(slot)->mem_size = fsize(file);
+			ESP_LOGI(TAG, "%d Bytes an Speicher werden Reserviert", APP(slot)->mem_size);
+			// Nur bis zur Relokation gebraucht, heap aus dem Manifest gilt für malloc der App
+			APP(slot)->exec_mem = heap_caps_malloc(APP(slot)->mem_size, MALLOC_CAP_SPIRAM);
+			fread(APP(slot)->exec_mem, 1, APP(slot)->mem_size, file);
+			fclose(file);
+		}
+
+		// Relokation der ELF-Datei (zugehörigen Code im Speicher anpassen). Ist der
+		// Speicher knapp, werden unbenutzte Images verworfen und es wird erneut versucht.
+		int ret = app_load(slot, filename);
+		if (ret == -ENOMEM && app_cache_trim() > 0) {
+			ret = app_load(slot, filename);
+		}
+
+		// Die Datei wird nach der Relokation nicht mehr gebraucht
+		heap_caps_free(APP(slot)->exec_mem);
+		APP(slot)->exec_mem = NULL;
+
+		if (ret != 0) {
+			ESP_LOGE(TAG, "Relokation von %s fehlgeschlagen (%d)", appname, ret);
+			memset(&APP(slot)->elf, 0, sizeof(esp_elf_t));
+			app_loader_abort(slot);
+			return -4;
+		}
+
+		// Reloziertes Image für spätere Starts aufheben
+		if (APP(slot)->lib_count == 0) {
+			APP(slot)->image = app_cache_put(filename, st.st_mtime, st.st_size, &APP(slot)->elf);
+		}
+	}
+	res->load_us = (uint32_t)(esp_timer_get_time() - start);
+
+	const AppManifest_t *manifest = &APP(slot)->manifest;
+	if (xTaskCreatePinnedToCore(start_app, APP(slot)->name, manifest->stack, (void *)(uintptr_t)slot,
+			manifest->priority, &APP(slot)->AppHandle, manifest->core) != pdPASS) {
+		ESP_LOGE(TAG, "Task für %s konnte nicht erstellt werden", appname);
+		app_loader_abort(slot);
+		return -5;
+	}
+	res->total_us = (uint32_t)(esp_timer_get_time() - req->queued);
+	ESP_LOGI(TAG, "App %s registriert (Slot %d, Warteschlange %lu us, Laden %lu us, gesamt %lu us)",
+		appname, slot, (unsigned long)res->wait_us, (unsigned long)res->load_us, (unsigned long)res->total_us);
 	return 1;
 }
 
-int unregisterApp(const char *appname) {
-	for(uint16_t i = 0; i < MAX_APPS; i++)
-	{
-		if(strcmp(Apps[i].name, appname) == 0)
-		{
-			close_app(i);
-			ESP_LOGI(TAG, "App %s wurde entfernt", appname);
-			return 1;
+static void app_loader_task(void *arg) {
+	AppLoadRequest req;
+	for (;;) {
+		if (xQueueReceive(app_loader_queue, &req, portMAX_DELAY) != pdTRUE) {
+			continue;
+		}
+		AppLoadResult_t res;
+		memset(&res, 0, sizeof(res));
+		res.status = app_loader_run(&req, &res);
+		if (req.result != NULL) {
+			*req.result = res;
+		}
+		if (req.notify != NULL) {
+			xTaskNotifyGive(req.notify);
 		}
 	}
-	ESP_LOGE(TAG, "App %s nicht gefunden", appname);
-	return -1;
+}
+
+// Startet die Loader-Tasks
+static int app_loader_init() {
+	app_loader_queue = xQueueCreate(APP_LOADER_QUEUE_DEPTH, sizeof(AppLoadRequest));
+	if (app_loader_queue == NULL) {
+		return -1;
+	}
+	for (int i = 0; i < APP_LOADER_WORKERS; i++) {
+		char name[configMAX_TASK_NAME_LEN];
+		snprintf(name, sizeof(name), "app_loader%d", i);
+		if (xTaskCreatePinnedToCore(app_loader_task, name, APP_LOADER_STACK, NULL,
+				APP_LOADER_PRIORITY, NULL, (APP_LOADER_CORE + i) % portNUM_PROCESSORS) != pdPASS) {
+			return -1;
+		}
+	}
+	return 0;
+}
+
+// Gibt einen Ladeauftrag an den Loader und kehrt sofort zurück. Ist notify gesetzt,
+// bekommt der Task nach Abschluss eine Task-Notification (Index 0), result enthält
+// dann Status und Zeiten. Aufträge werden in der Reihenfolge ihres Eingangs angenommen,
+// können aber in anderer Reihenfolge fertig werden.
+int app_load_async(const char *appname, TaskHandle_t notify, AppLoadResult_t *result) {
+	if (app_loader_queue == NULL || appname == NULL || strlen(appname) >= APP_NAME_MAX_LEN) {
+		return -1;
+	}
+	AppLoadRequest req = {
+		.notify = notify,
+		.result = result,
+		.queued = esp_timer_get_time(),
+	};
+	strcpy(req.name, appname);
+	return xQueueSend(app_loader_queue, &req, 0) == pdTRUE ? 0 : -1;
+}
+
+// Lädt und startet eine App und wartet, bis der Loader fertig ist
+int registerApp(const char *appname)
+{
+	AppLoadResult_t res;
+	ulTaskNotifyTake(pdTRUE, 0);
+	if (app_load_async(appname, xTaskGetCurrentTaskHandle(), &res) != 0) {
+		ESP_LOGE(TAG, "Loader für %s nicht verfügbar", appname);
+		return -1;
+	}
+	ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+	return res.status;
+}
+
+// Beendet eine App: sie bekommt "exit" auf stdin und hat grace_ms Zeit, ihren
+// Einsprungpunkt zu verlassen (negativ = Wert aus dem Manifest). Danach wird ihr
+// Task gelöscht, steckt sie in einem Systemaufruf mit OS-Sperre, erst nach dessen
+// Ende. Eigene Mutexe der App bleiben belegt. Liefert 1, -1 (keine solche App)
+// oder -2 (wird gerade geladen oder schon beendet).
+int app_stop(int id, int grace_ms, AppStopResult_t *result) {
+	int64_t start = esp_timer_get_time();
+	AppStopResult_t res = { .status = -1 };
+	int16_t slot = app_slot_of(id);
+	App_t *app = slot < 0 ? NULL : APP(slot);
+
+	taskENTER_CRITICAL(&app_lock);
+	if (app != NULL && app->running) {
+		res.status = (app->AppHandle == NULL || app->exiting || app->stopping) ? -2 : 1;
+		if (res.status == 1) {
+			app->stopping = 1;
+		}
+	}
+	taskEXIT_CRITICAL(&app_lock);
+	if (res.status != 1) {
+		if (result != NULL) {
+			*result = res;
+		}
+		return res.status;
+	}
+
+	char name[APP_NAME_MAX_LEN];
+	snprintf(name, sizeof(name), "%s", app->name);
+	if (grace_ms < 0) {
+		grace_ms = app->manifest.stop_grace;
+	}
+	if (app->id > -1) {
+		sys_sendmsg_timeout(app->id, "exit", 4, 0);
+	}
+	EventBits_t bits = xEventGroupWaitBits(app->events, APP_EVT_EXITED, pdFALSE, pdTRUE, pdMS_TO_TICKS(grace_ms));
+	if (!(bits & APP_EVT_EXITED)) {
+		// Die App kann genau jetzt zurückkehren, daher unter der Sperre entscheiden
+		taskENTER_CRITICAL(&app_lock);
+		res.forced = !app->exiting;
+		app->exiting = 1;
+		uint8_t defer = res.forced && app->in_syscall > 0;
+		app->kill_pending = defer;
+		taskEXIT_CRITICAL(&app_lock);
+		if (defer) {
+			// Die Sperre würde nie wieder frei, app_cleanup bliebe daran hängen.
+			// Blockierende Aufrufe brechen nach einer Wartescheibe ab, länger als
+			// die Gnadenfrist wird trotzdem nicht gewartet.
+			ESP_LOGW(TAG, "App %s steckt in einem Systemaufruf, warte auf dessen Ende", name);
+			bits = xEventGroupWaitBits(app->events, APP_EVT_EXITED, pdFALSE, pdTRUE,
+				pdMS_TO_TICKS(grace_ms + APP_SYSCALL_SLICE_MS));
+			if (!(bits & APP_EVT_EXITED)) {
+				ESP_LOGE(TAG, "App %s verlässt den Systemaufruf nicht, Task wird trotzdem gelöscht", name);
+			}
+		}
+	}
+	vTaskDelete(app->AppHandle);
+	if (res.forced) {
+		// Läuft der Task auf dem anderen Kern, wird er erst beim nächsten Tick entfernt
+		vTaskDelay(1);
+		ESP_LOGW(TAG, "App %s reagiert nicht, Task nach %d ms gelöscht", name, grace_ms);
+	}
+
+	// Abschiedsnachricht der App, falls sie eine hinterlassen hat
+	char buffer[IPC_MSG_MAX_LEN];
+	if (app->stderror > -1 && sys_recvmsg_nb(app->stderror, buffer, sizeof(buffer)) == 0) {
+		printf("App %s: %s\n", name, buffer);
+	}
+	app_cleanup(slot);
+
+	res.stop_us = (uint32_t)(esp_timer_get_time() - start);
+	ESP_LOGI(TAG, "App %s nach %lu us beendet%s", name, (unsigned long)res.stop_us, res.forced ? " (erzwungen)" : "");
+	if (result != NULL) {
+		*result = res;
+	}
+	return 1;
+}
+
+// Beendet die App mit der angegebenen ID
+int unregisterAppId(int id) {
+	return app_stop(id, -1, NULL);
+}
+
+int unregisterApp(const char *appname) {
+	if (unregisterAppId(app_find(appname)) < 0) {
+		ESP_LOGE(TAG, "App %s nicht gefunden", appname);
+		return -1;
+	}
+	ESP_LOGI(TAG, "App %s wurde entfernt", appname);
+	return 1;
+}
+
+// Gibt den Kern als Text aus ("-" = beliebig)
+static const char *app_core_str(int core, char *buf, size_t len) {
+	if (core == tskNO_AFFINITY || core < 0 || core >= portNUM_PROCESSORS) {
+		return "-";
+	}
+	snprintf(buf, len, "%d", core);
+	return buf;
 }
 
 int printAppList(int argc, char **argv) {
 	printf("App List:\n");
-	for(uint16_t i = 0; i < MAX_APPS; i++)
+	printf("%-6s %-16s %7s %7s %9s %9s %8s %8s %s\n", "ID", "Name", "Stack", "Frei", "Prio k/i", "Kern k/i",
+		"Heap kB", "Spitze", "Manifest");
+
+	// IDs der belegten Slots kopieren, damit beim Ausgeben kein Lock gehalten wird
+	int *ids = malloc(APP_MAX_SLOTS * sizeof(int));
+	if (ids == NULL) {
+		return 1;
+	}
+	int count = 0;
+	taskENTER_CRITICAL(&app_lock);
+	for (int16_t i = app_live; i >= 0; i = APP(i)->live_next) {
+		ids[count++] = APP_ID(i, APP(i)->gen);
+	}
+	taskEXIT_CRITICAL(&app_lock);
+
+	for(int n = count - 1; n >= 0; n--)
 	{
-		if(Apps[i].running == 1)
+		int16_t i = app_slot_of(ids[n]);
+		if(i >= 0)
 		{
-			printf("App %d: %s\n", i, Apps[i].name);
+			const AppManifest_t *m = &APP(i)->manifest;
+			TaskHandle_t task = APP(i)->AppHandle;
+			char cfg_core[4], act_core[4];
+			// Während des Ladens gibt es noch keinen Task
+			if (task == NULL) {
+				printf("%-6d %-16s %7lu %7s %4d/%-4s %4s/%-4s %8s %8s %s\n", ids[n], APP(i)->name, (unsigned long)m->stack, "-",
+					m->priority, "-", app_core_str(m->core, cfg_core, sizeof(cfg_core)), "-", "-", "-",
+					m->from_file ? "ja" : "nein");
+				continue;
+			}
+			printf("%-6d %-16s %7lu %7lu %4d/%-4d %4s/%-4s %8.1f %8.1f %s\n", ids[n], APP(i)->name, (unsigned long)m->stack,
+				(unsigned long)uxTaskGetStackHighWaterMark(task), m->priority, (int)uxTaskPriorityGet(task),
+				app_core_str(m->core, cfg_core, sizeof(cfg_core)),
+				app_core_str(xTaskGetCoreID(task), act_core, sizeof(act_core)),
+				APP(i)->heap_live / 1024.0f, APP(i)->heap_peak / 1024.0f, m->from_file ? "ja" : "nein");
 		}
 	}
+	free(ids);
+	app_lib_print();
 	return 0;
 }
 
 void initApps()
 {
 	ESP_LOGI(TAG, "Init App Locators");
-	for(uint16_t i = 0; i < MAX_APPS; i++)
+	for(uint16_t i = 0; i < APP_HASH_BUCKETS; i++)
+	{
+		app_hash[i] = -1;
+	}
+	// Der erste Block wird gleich angelegt, weitere erst bei Bedarf
+	if (app_slots == 0 && app_grow() != 0)
 	{
-		Apps[i].AppHandle = NULL;
-		esp_elf_deinit(&Apps[i].elf);
-		Apps[i].mem_size = 0;
-		Apps[i].exec_mem = NULL;
-		Apps[i].name = "";
-		Apps[i].running = 0;
-		Apps[i].id = 0xFF;
-		Apps[i].stderror = 0xFF;
+		ESP_LOGE(TAG, "App-Tabelle konnte nicht angelegt werden");
 	}
 }
 
 int8_t init_systemcalls() {
-	elf_set_custom_symbols(elf_symbols);
+	ipc_init();
+	app_cache_init();
+	// Ohne App-Partition laufen alle Apps aus dem RAM
+	app_xip_init();
+	// OS-Symbole vor allen anderen Tabellen, damit die Heap-Wrapper gewinnen
+	if (elf_register_symbols(elf_symbols, "os") != 0) {
+		ESP_LOGE(TAG, "[APP] Failed to register OS symbols");
+		return -5;
+	}
+	if (app_lib_init() != 0) {
+		ESP_LOGE(TAG, "[APP] Failed to init library table");
+		return -4;
+	}
+	if (app_loader_init() != 0) {
+		ESP_LOGE(TAG, "[APP] Failed to start app loader");
+		return -3;
+	}
 	SysLedMutex = xSemaphoreCreateBinary();
 	if (SysLedMutex == NULL) {
 		ESP_LOGE(TAG, "[APP] Failed to create SysLedMutex semaphore");